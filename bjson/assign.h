@@ -9,6 +9,7 @@
 
 #include "json_spirit_value.h"
 #include "json_pointer.h"
+#include "key.h"
 #include "scrt/compat_features.h"
 
 #include <boost/range/iterator_range.hpp>
@@ -146,9 +147,9 @@ struct Pointer_Inserter
     }
 
     #define POINTER_INSERTER_DEFINE(TYPE) \
-    Pointer_Inserter& operator()(const String_type& name, TYPE value) \
+    Pointer_Inserter& operator()(std::string_view name, TYPE value) \
     { \
-        pointer.path(name.c_str()); \
+        pointer.path(name); \
         pointer.set(val, value); \
         return *this; \
     }
@@ -169,9 +170,9 @@ struct Pointer_Inserter
     #undef POINTER_INSERTER_DEFINE
 
     #define POINTER_MOVEABLE_INSERTER_DEFINE(TYPE) \
-    Pointer_Inserter& operator()(const String_type& name, TYPE value) \
+    Pointer_Inserter& operator()(std::string_view name, TYPE value) \
     { \
-        pointer.path(name.c_str()); \
+        pointer.path(name); \
         pointer.set(val, std::move(value)); \
         return *this; \
     }
@@ -185,7 +186,7 @@ struct Pointer_Inserter
     #undef POINTER_MOVEABLE_INSERTER_DEFINE
 
     template<typename T>
-    Pointer_Inserter& operator()(const String_type& name, Skip_Inserting_Tag<T> wrapper)
+    Pointer_Inserter& operator()(std::string_view name, Skip_Inserting_Tag<T> wrapper)
     {
         if (wrapper.valid)
             (*this).operator()(name, std::forward<T>(wrapper.value));
@@ -210,7 +211,7 @@ struct Object_Inserter
 
 #if __cpp_ref_qualifiers >= 200710
     template<typename T>
-    Object_Inserter& operator()(const String_type& name, Skip_Inserting_Tag<T> wrapper) &
+    Object_Inserter& operator()(const Key& name, Skip_Inserting_Tag<T> wrapper) &
     {
         if (wrapper.valid)
             (*this).operator()(name, std::forward<T>(wrapper.value));
@@ -219,7 +220,7 @@ struct Object_Inserter
     }
 
     template<typename T>
-    Object_Inserter& operator()(const String_type& name, Skip_NULL_Tag<T> wrapper) &
+    Object_Inserter& operator()(const Key& name, Skip_NULL_Tag<T> wrapper) &
     {
         if (wrapper.ptr)
             this->operator()(name, *wrapper.ptr);
@@ -227,9 +228,9 @@ struct Object_Inserter
         return *this;
     }
 
-    Object_Inserter& operator()(const String_type& name, Value val) &
+    Object_Inserter& operator()(const Key& name, Value val) &
     {
-        obj[name] = std::move(val);
+        obj[Object::key_type(name.str())] = std::move(val);
         return *this;
     }
 
@@ -247,7 +248,7 @@ struct Object_Inserter
     }
 #else // __cpp_ref_qualifiers < 200710
     template<typename T>
-    Object_Inserter&& operator()(const String_type& name, Skip_Inserting_Tag<T> wrapper)
+    Object_Inserter&& operator()(const Key& name, Skip_Inserting_Tag<T> wrapper)
     {
         if (wrapper.valid)
             (*this).operator()(name, std::forward<T>(wrapper.value));
@@ -256,7 +257,7 @@ struct Object_Inserter
     }
 
     template<typename T>
-    Object_Inserter&& operator()(const String_type& name, Skip_NULL_Tag<T> wrapper)
+    Object_Inserter&& operator()(const Key& name, Skip_NULL_Tag<T> wrapper)
     {
         if (wrapper.ptr)
             this->operator()(name, *wrapper.ptr);
@@ -264,9 +265,9 @@ struct Object_Inserter
         return std::move(*this);
     }
 
-    Object_Inserter&& operator()(const String_type& name, Value val)
+    Object_Inserter&& operator()(const Key& name, Value val)
     {
-        obj[name] = std::move(val);
+        obj[Object::key_type(name.str())] = std::move(val);
         return std::move(*this);
     }
 
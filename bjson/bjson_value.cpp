@@ -1,106 +1,370 @@
 #include "bjson_value.h"
 
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 
 namespace bjson {
 
-const Value Value::null;
+static_assert(sizeof(Value) <= 16, "bjson::Value should fit in 16 bytes");
+
+using std::pmr::memory_resource;
 
-Value::Value() : v_(Null_Fn())
+template <class T, class... Args>
+static T* new_box(memory_resource* mr, Args&&... args)
 {
+    void* p = mr->allocate(sizeof(T), alignof(T));
+    try {
+        return ::new (p) T(std::forward<Args>(args)...);
+    } catch (...) {
+        mr->deallocate(p, sizeof(T), alignof(T));
+        throw;
+    }
 }
 
-// destructor stub to get rid of 'W' symbol in share objects that depend on.
-Value::~Value()
+template <class T>
+static void delete_box(memory_resource* mr, T* p) noexcept
 {
+    p->~T();
+    mr->deallocate(p, sizeof(T), alignof(T));
 }
 
-Value::Value(const char* value) : v_(std::string(value))
+// Elements of a packed array as the parser would have made them.
+static Value unpacked(int64_t value)
+{
+    return value >= 0 ? Value(static_cast<uint64_t>(value)) : Value(value);
+}
+
+static Value unpacked(double value)
+{
+    return Value(value);
+}
+
+// The last reference frees the box, whichever copy held it.
+template <class Box>
+static bool release(Box* box) noexcept
+{
+    return box->refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+// Box of the boxed forms of a packed array.
+template <class Box>
+using Boxed = typename std::remove_pointer<decltype(std::declval<Box&>().boxed.load())>::type;
+
+// Boxed form of a packed array, elements as the parser would have made them.
+template <class Box>
+static Boxed<Box>* unpacked_box(const Box* box, memory_resource* mr)
 {
+    auto* arr = new_box<Boxed<Box>>(mr, Array::allocator_type(mr));
+    try {
+        arr->value.reserve(box->vec.size());
+        for (const auto v : box->vec)
+            arr->value.push_back(unpacked(v));
+    } catch (...) {
+        delete_box(mr, arr);
+        throw;
+    }
+
+    return arr;
 }
 
-Value::Value(const std::string& value) : v_(value)
+template <class Box>
+static Array* boxed_view(const Box* box)
 {
+    Boxed<Box>* arr = box->boxed.load(std::memory_order_acquire);
+    if (arr)
+        return &arr->value;
+
+    memory_resource* mr = box->vec.get_allocator().resource();
+    Boxed<Box>* fresh = unpacked_box(box, mr);
+    if (box->boxed.compare_exchange_strong(arr, fresh,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+        return &fresh->value;
+
+    delete_box(mr, fresh);
+    return &arr->value;
 }
 
-Value::Value(std::string&& value) : v_(std::move(value))
+// The boxed view no longer matches once the buffer is handed out for
+// writing, a later get_array() const makes a new one.
+template <class Box>
+static void retire_boxed_view(Box* box)
 {
+    if (!box->boxed.load(std::memory_order_acquire))
+        return;
+
+    box->retired.reserve(box->retired.size() + 1);
+    box->retired.push_back(box->boxed.exchange(nullptr, std::memory_order_acq_rel));
 }
 
-Value::Value(const Object& value) : v_(value)
+template <class Box>
+static void drop_boxed_views(Box* box) noexcept
 {
+    memory_resource* mr = box->vec.get_allocator().resource();
+    if (Boxed<Box>* arr = box->boxed.exchange(nullptr, std::memory_order_acq_rel))
+        delete_box(mr, arr);
+
+    for (Boxed<Box>* arr : box->retired)
+        delete_box(mr, arr);
+
+    box->retired.clear();
 }
 
-Value::Value(Object&& value) : v_(std::move(value))
+template <class Box>
+static void delete_packed(Box* box) noexcept
 {
+    if (!release(box))
+        return;
+
+    drop_boxed_views(box);
+    delete_box(box->vec.get_allocator().resource(), box);
 }
 
-Value::Value(const Array& value) : v_(value)
+// 64 bits finalizer of MurmurHash3, integers hash to themselves otherwise.
+static size_t fmix(uint64_t x)
 {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb53fe1a85ec4ULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
 }
 
-Value::Value(Array&& value) : v_(std::move(value))
+static size_t hash_combine(size_t h, size_t v)
 {
+    return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
 }
 
-Value::Value(bool value) : v_(value)
+// Seeds keep {}, [] and "" apart.
+static const size_t obj_seed = 0x6f626a;
+static const size_t array_seed = 0x617272;
+static const size_t str_seed = 0x737472;
+
+// int64 and uint64 hash alike by their bits, a packed element hashes as
+// the value it unpacks to.
+static size_t hash_integer(uint64_t value)
 {
+    return fmix(value);
 }
 
-Value::Value(int value) : v_(static_cast<int64_t>(value))
+static size_t hash_real(double value)
 {
+    if (value == 0)
+        value = 0;  // -0.0 == 0.0
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return fmix(bits ^ 0x7265616cULL);
 }
 
-Value::Value(unsigned value) : v_(static_cast<uint64_t>(value))
+const Value Value::null;
+
+Value::Value(const char* value)
+    : Value(value, std::pmr::get_default_resource())
 {
 }
 
-#if __SIZEOF_LONG__ == 4
-Value::Value(long value) : v_(static_cast<int64_t>(value))
+Value::Value(const std::string& value)
+    : Value(value, std::pmr::get_default_resource())
 {
 }
 
-Value::Value(unsigned long value) : v_(static_cast<uint64_t>(value))
+Value::Value(std::string&& value)
+    : Value(std::move(value), std::pmr::get_default_resource())
 {
 }
-#endif // __SIZEOF_LONG__ == 4
 
-Value::Value(int64_t value) : v_(value)
+Value::Value(const char* value, memory_resource* mr) : tag_(str_tag)
 {
+    data_.str = new_box<Str_Box>(mr, mr, value);
 }
 
-Value::Value(uint64_t value) : v_(value)
+Value::Value(const std::string& value, memory_resource* mr) : tag_(str_tag)
 {
+    data_.str = new_box<Str_Box>(mr, mr, value);
 }
 
-Value::Value(double value) : v_(value)
+Value::Value(std::string&& value, memory_resource* mr) : tag_(str_tag)
 {
+    data_.str = new_box<Str_Box>(mr, mr, std::move(value));
 }
 
-Value::Value(const Value& other) : v_(other.v_)
+Value::Value(std::string_view value, memory_resource* mr) : tag_(str_tag)
 {
+    data_.str = new_box<Str_Box>(mr, mr, value);
 }
 
-Value::Value(Value&& other) : v_(std::move(other.v_))
+// A copy is allocated from the default resource, as the pmr containers do.
+Value::Value(const Object& value) : tag_(obj_tag)
 {
+    data_.obj = new_box<Obj_Box>(std::pmr::get_default_resource(), value);
+}
+
+// A move keeps the allocator, so the box goes where the elements already are.
+Value::Value(Object&& value) : tag_(obj_tag)
+{
+    data_.obj = new_box<Obj_Box>(value.get_allocator().resource(),
+                                 std::move(value));
+}
+
+Value::Value(const Array& value) : tag_(array_tag)
+{
+    data_.arr = new_box<Arr_Box>(std::pmr::get_default_resource(), value);
+}
+
+Value::Value(Array&& value) : tag_(array_tag)
+{
+    data_.arr = new_box<Arr_Box>(value.get_allocator().resource(),
+                                 std::move(value));
+}
+
+Value::Value(Int64_Array&& value) : tag_(int_array_tag)
+{
+    data_.ints = new_box<Int64_Box>(value.get_allocator().resource(),
+                                    std::move(value));
+}
+
+Value::Value(Real_Array&& value) : tag_(real_array_tag)
+{
+    data_.reals = new_box<Real_Box>(value.get_allocator().resource(),
+                                    std::move(value));
+}
+
+Value::Value(const Value& other)
+    : Value(other, std::pmr::get_default_resource())
+{
+}
+
+// A box is shared when it stays in the same resource, it must not outlive
+// an arena it came from.
+Value::Value(const Value& other, memory_resource* mr)
+    : data_(other.data_), tag_(other.tag_)
+{
+    Shared* box = other.shared();
+    if (!box)
+        return;
+
+    if (!box->referenced && mr->is_equal(*other.resource())) {
+        box->refs.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    clone_box(other, mr);
+}
+
+// The containers copy their elements with uses-allocator construction,
+// which brings the nested values into mr as well, sharing them if they
+// were in mr already.
+void Value::clone_box(const Value& other, memory_resource* mr)
+{
+    switch (other.tag_) {
+    case obj_tag:
+        data_.obj = new_box<Obj_Box>(mr, other.data_.obj->value,
+                                     Object::allocator_type(mr));
+        break;
+    case array_tag:
+        data_.arr = new_box<Arr_Box>(mr, other.data_.arr->value,
+                                     Array::allocator_type(mr));
+        break;
+    case str_tag:
+        data_.str = new_box<Str_Box>(mr, mr, other.data_.str->str);
+        break;
+    case int_array_tag:
+        data_.ints = new_box<Int64_Box>(mr, other.data_.ints->vec, mr);
+        break;
+    case real_array_tag:
+        data_.reals = new_box<Real_Box>(mr, other.data_.reals->vec, mr);
+        break;
+    default:
+        break;
+    }
 }
 
 Value& Value::operator=(const Value& rhs)
 {
-    v_ = rhs.v_;
+    // Copy first, rhs may be a descendant of this value.
+    Value tmp(rhs);
+    swap(tmp);
     return *this;
 }
 
 Value& Value::operator=(Value&& rhs)
 {
-    v_ = std::move(rhs.v_);
+    if (this != &rhs) {
+        Value tmp(std::move(rhs));
+        swap(tmp);
+    }
+
     return *this;
 }
 
 bool Value::operator==(const Value& rhs) const
 {
-    return this == &rhs || (type() == rhs.type() && v_ == rhs.v_);
+    if (this == &rhs)
+        return true;
+
+    if (tag_ == rhs.tag_ && shared() && shared() == rhs.shared())
+        return true;
+
+    const size_t h = cached_hash();
+    const size_t rh = rhs.cached_hash();
+    if (h && rh && h != rh)
+        return false;
+
+    if (tag_ != rhs.tag_) {
+        // Packed or not, arrays of the same elements are equal.
+        if (type() == array_type && rhs.type() == array_type)
+            return get_array() == rhs.get_array();
+
+        return false;
+    }
+
+    switch (tag_) {
+    case obj_tag:
+        return data_.obj->value == rhs.data_.obj->value;
+    case array_tag:
+        return data_.arr->value == rhs.data_.arr->value;
+    case str_tag:
+        return data_.str->str == rhs.data_.str->str;
+    case bool_tag:
+        return data_.boolean == rhs.data_.boolean;
+    case int_tag:
+        return data_.i64 == rhs.data_.i64;
+    case uint_tag:
+        return data_.u64 == rhs.data_.u64;
+    case real_tag:
+        return data_.real == rhs.data_.real;
+    case int_array_tag:
+        return data_.ints->vec == rhs.data_.ints->vec;
+    case real_array_tag:
+        return data_.reals->vec == rhs.data_.reals->vec;
+    case null_tag:
+        break;
+    }
+
+    return true;
+}
+
+memory_resource* Value::resource() const
+{
+    switch (tag_) {
+    case obj_tag:
+        return data_.obj->value.get_allocator().resource();
+    case array_tag:
+        return data_.arr->value.get_allocator().resource();
+    case str_tag:
+        return data_.str->mr;
+    case int_array_tag:
+        return data_.ints->vec.get_allocator().resource();
+    case real_array_tag:
+        return data_.reals->vec.get_allocator().resource();
+    default:
+        return nullptr;
+    }
 }
 
 bool Value::compare_only_value(const Value& rhs) const
@@ -121,140 +385,313 @@ bool Value::compare_only_value(const Value& rhs) const
     return *this == rhs;
 }
 
-Vtype Value::type() const
-{
-    return is_uint64() ? int_type : static_cast<Vtype>(v_.which());
-}
+size_t Value::hash() const
+{
+    Shared* box = shared();
+    if (!box)
+        return compute_hash();
+
+    size_t h = box->hash.load(std::memory_order_relaxed);
+    if (h)
+        return h;
+
+    h = compute_hash();
+    if (!h)
+        h = 1;
+
+    if (!box->referenced)
+        box->hash.store(h, std::memory_order_relaxed);
+
+    return h;
+}
+
+size_t Value::cached_hash() const
+{
+    const Shared* box = shared();
+    return box ? box->hash.load(std::memory_order_relaxed) : 0;
+}
+
+size_t Value::compute_hash() const
+{
+    size_t h;
+    switch (tag_) {
+    case obj_tag:
+        h = obj_seed;
+        for (const auto& i : data_.obj->value) {
+            h = hash_combine(h, std::hash<Object::key_type>()(i.first));
+            h = hash_combine(h, i.second.hash());
+        }
+        return h;
+    case array_tag:
+        h = array_seed;
+        for (const auto& i : data_.arr->value)
+            h = hash_combine(h, i.hash());
+        return h;
+    case int_array_tag:
+        h = array_seed;
+        for (const auto i : data_.ints->vec)
+            h = hash_combine(h, hash_integer(static_cast<uint64_t>(i)));
+        return h;
+    case real_array_tag:
+        h = array_seed;
+        for (const auto i : data_.reals->vec)
+            h = hash_combine(h, hash_real(i));
+        return h;
+    case str_tag:
+        return hash_combine(str_seed, std::hash<std::string>()(data_.str->str));
+    case bool_tag:
+        return data_.boolean ? 0x74727565 : 0x66616c73;
+    case int_tag:
+        return hash_integer(static_cast<uint64_t>(data_.i64));
+    case uint_tag:
+        return hash_integer(data_.u64);
+    case real_tag:
+        return hash_real(data_.real);
+    case null_tag:
+        break;
+    }
 
-bool Value::is_null() const
-{
-    return type() == null_type;
+    return 0x6e756c6c;
 }
 
-bool Value::is_uint64() const
+Span<int64_t> Value::get_int64_span()
 {
-    return v_.which() == null_type + 1;
-}
+    if (tag_ != int_array_tag)
+        throw std::runtime_error("value is not a packed int64 array");
 
-Object& Value::get_obj()
-{
-    check_type(obj_type);
-    return *boost::get<Object>(&v_);
+    own();
+    retire_boxed_view(data_.ints);
+    return Span<int64_t>(data_.ints->vec.data(), data_.ints->vec.size());
 }
 
-const Object& Value::get_obj() const
+Span<const int64_t> Value::get_int64_span() const
 {
-    check_type(obj_type);
-    return *boost::get<Object>(&v_);
-}
+    if (tag_ != int_array_tag)
+        throw std::runtime_error("value is not a packed int64 array");
 
-Array& Value::get_array()
-{
-    check_type(array_type);
-    return *boost::get<Array>(&v_);
+    return Span<const int64_t>(data_.ints->vec.data(), data_.ints->vec.size());
 }
 
-const Array& Value::get_array() const
+Span<double> Value::get_real_span()
 {
-    check_type(array_type);
-    return *boost::get<Array>(&v_);
-}
+    if (tag_ != real_array_tag)
+        throw std::runtime_error("value is not a packed real array");
 
-std::string& Value::get_str()
-{
-    check_type(str_type);
-    return *boost::get<std::string>(&v_);
+    own();
+    retire_boxed_view(data_.reals);
+    return Span<double>(data_.reals->vec.data(), data_.reals->vec.size());
 }
 
-const std::string& Value::get_str() const
+Span<const double> Value::get_real_span() const
 {
-    check_type(str_type);
-    return *boost::get<std::string>(&v_);
-}
+    if (tag_ != real_array_tag)
+        throw std::runtime_error("value is not a packed real array");
 
-bool Value::get_bool() const
-{
-    check_type(bool_type);
-    return boost::get<bool>(v_);
+    return Span<const double>(data_.reals->vec.data(), data_.reals->vec.size());
 }
 
-int Value::get_int() const
+bool Value::pack_array()
 {
-    check_type(int_type);
-    return static_cast<int>(get_int64());
-}
+    if (tag_ == int_array_tag || tag_ == real_array_tag)
+        return true;
 
-unsigned Value::get_uint() const
-{
-    check_type(int_type);
-    return static_cast<unsigned>(get_uint64());
-}
+    if (tag_ != array_tag || data_.arr->value.empty())
+        return false;
 
-long Value::get_long() const
-{
-    check_type(int_type);
-    return static_cast<long>(get_int64());
+    // Check every element first, a failed attempt allocates nothing.
+    const Array& arr = data_.arr->value;
+    const bool reals = arr.front().tag_ == real_tag;
+    for (const auto& v : arr) {
+        const bool ok = reals ? v.tag_ == real_tag
+                              : (v.tag_ == int_tag && v.data_.i64 < 0) ||
+                                    (v.tag_ == uint_tag &&
+                                     v.data_.u64 <= static_cast<uint64_t>(
+                                         std::numeric_limits<int64_t>::max()));
+        if (!ok)
+            return false;
+    }
+
+    memory_resource* mr = arr.get_allocator().resource();
+    if (reals) {
+        Real_Array vec(mr);
+        vec.reserve(arr.size());
+        for (const auto& v : arr)
+            vec.push_back(v.data_.real);
+
+        *this = Value(std::move(vec));
+    } else {
+        Int64_Array vec(mr);
+        vec.reserve(arr.size());
+        for (const auto& v : arr)
+            vec.push_back(v.tag_ == int_tag ? v.data_.i64
+                                            : static_cast<int64_t>(v.data_.u64));
+
+        *this = Value(std::move(vec));
+    }
+
+    return true;
 }
 
-unsigned long Value::get_ulong() const
+const Array& Value::boxed_array() const
 {
-    check_type(int_type);
-    return static_cast<unsigned long>(get_uint64());
+    return tag_ == int_array_tag ? *boxed_view(data_.ints)
+                                 : *boxed_view(data_.reals);
 }
 
-int64_t Value::get_int64() const
+// The boxed view becomes the array when no copy shares the packed one, so
+// references from get_array() const stay valid and see later writes.
+Array& Value::unpack_array()
 {
-    check_type(int_type);
-    return is_uint64() ? static_cast<int64_t>(boost::get<uint64_t>(v_))
-                       : boost::get<int64_t>(v_);
+    memory_resource* mr = resource();
+    const bool alone = shared()->refs.load(std::memory_order_acquire) == 1;
+    Arr_Box* box = nullptr;
+    if (tag_ == int_array_tag) {
+        if (alone)
+            box = data_.ints->boxed.exchange(nullptr, std::memory_order_acq_rel);
+
+        if (!box)
+            box = unpacked_box(data_.ints, mr);
+    } else {
+        if (alone)
+            box = data_.reals->boxed.exchange(nullptr, std::memory_order_acq_rel);
+
+        if (!box)
+            box = unpacked_box(data_.reals, mr);
+    }
+
+    destroy();
+    data_.arr = box;
+    tag_ = array_tag;
+    box->referenced = true;
+    return box->value;
 }
 
-uint64_t Value::get_uint64() const
+void Value::unshare()
 {
-    check_type(int_type);
-    return is_uint64() ? boost::get<uint64_t>(v_)
-                       : static_cast<uint64_t>(boost::get<int64_t>(v_));
+    Value tmp;
+    tmp.clone_box(*this, resource());
+    tmp.tag_ = tag_;
+    swap(tmp);
 }
 
-double Value::get_real() const
+void Value::make_shareable(bool deep)
 {
-    if (type() == int_type)
-        return is_uint64() ? static_cast<double>(get_uint64())
-                           : static_cast<double>(get_int64());
+    Shared* box = shared();
+    if (!box)
+        return;
+
+    // Values below a box already shared were not referenced when the box
+    // was first shared, and nobody could have referenced them since.
+    box->referenced = false;
 
-    check_type(real_type);
-    return boost::get<double>(v_);
+    // Nothing refers to the boxed views of a packed array any more.
+    if (box->refs.load(std::memory_order_acquire) == 1) {
+        if (tag_ == int_array_tag)
+            drop_boxed_views(data_.ints);
+        else if (tag_ == real_array_tag)
+            drop_boxed_views(data_.reals);
+    }
+
+    if (!deep || box->refs.load(std::memory_order_acquire) != 1)
+        return;
+
+    if (tag_ == obj_tag) {
+        for (auto&& i : data_.obj->value)
+            i.second.make_shareable(true);
+    } else if (tag_ == array_tag) {
+        for (auto& i : data_.arr->value)
+            i.make_shareable(true);
+    }
 }
 
 Object& Value::to_new_object()
 {
-    v_ = Object();
-    return *boost::get<Object>(&v_);
+    *this = Object();
+    return get_obj();
 }
 
 Array& Value::to_new_array()
 {
-    v_ = Array();
-    return *boost::get<Array>(&v_);
+    *this = Array();
+    return get_array();
+}
+
+void Value::destroy() noexcept
+{
+    switch (tag_) {
+    case obj_tag:
+    case array_tag:
+        if (release(shared()))
+            destroy_tree();
+        break;
+    case str_tag:
+        if (release(data_.str))
+            delete_box(data_.str->mr, data_.str);
+        break;
+    case int_array_tag:
+        delete_packed(data_.ints);
+        break;
+    case real_array_tag:
+        delete_packed(data_.reals);
+        break;
+    default:
+        break;
+    }
 }
 
-inline Object& Value::to_object()
+// Nested containers are moved to a list before their parent is freed, so a
+// deep tree is taken apart in a loop instead of by recursive destructors.
+void Value::destroy_tree() noexcept
 {
-    return type() == obj_type ? get_obj() : to_new_object();
+    std::vector<Value> pending;
+    take_nested(pending);
+    free_container();
+
+    while (!pending.empty()) {
+        Value v(std::move(pending.back()));
+        pending.pop_back();
+        if (release(v.shared())) {
+            v.take_nested(pending);
+            v.free_container();
+        }
+
+        v.tag_ = null_tag;
+    }
+}
+
+// Strings and scalars stay, their destructors do not recurse. Whatever is
+// left after a failed allocation is destroyed with its container.
+void Value::take_nested(std::vector<Value>& pending) noexcept
+{
+    try {
+        if (tag_ == obj_tag) {
+            for (auto&& i : data_.obj->value) {
+                if (i.second.tag_ == obj_tag || i.second.tag_ == array_tag)
+                    pending.push_back(std::move(i.second));
+            }
+        } else {
+            for (auto& i : data_.arr->value) {
+                if (i.tag_ == obj_tag || i.tag_ == array_tag)
+                    pending.push_back(std::move(i));
+            }
+        }
+    } catch (...) {
+    }
 }
 
-inline Array& Value::to_array()
+void Value::free_container() noexcept
 {
-    return type() == array_type ? get_array() : to_new_array();
+    if (tag_ == obj_tag)
+        delete_box(data_.obj->value.get_allocator().resource(), data_.obj);
+    else
+        delete_box(data_.arr->value.get_allocator().resource(), data_.arr);
 }
 
-void Value::check_type(const Vtype vtype) const
+void Value::throw_type_error(const Vtype vtype) const
 {
-    if (type() != vtype) {
-        std::ostringstream os;
-        os << "value type is " << type() << " not " << vtype;
-        throw std::runtime_error(os.str());
-    }
+    std::ostringstream os;
+    os << "value type is " << type() << " not " << vtype;
+    throw std::runtime_error(os.str());
 }
 
 };
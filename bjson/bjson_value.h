@@ -1,13 +1,30 @@
 #ifndef BJSON_VALUE_H
 #define BJSON_VALUE_H
 
-#include <map>
+#include "bjson_export.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#ifdef BJSON_FLAT_OBJECT
+#include "flat_map.h"
+#else
+#include <map>
+#endif // BJSON_FLAT_OBJECT
+
+#ifdef BJSON_INTERNED_KEYS
+#include "interned_string.h"
+#endif // BJSON_INTERNED_KEYS
+
 #include <boost/config.hpp>
 #include <boost/cstdint.hpp>
-#include <boost/variant.hpp>
 
 namespace bjson {
 enum Vtype
@@ -26,12 +43,88 @@ struct Null_Fn
 };
 
 class Value;
-using Object = std::map<std::string, Value>;
-using Array = std::vector<Value>;
+struct Memory_Usage;
+
+// The comparator is transparent, so lookups by std::string_view or
+// const char* do not build a key.
+#ifdef BJSON_INTERNED_KEYS
+using Object_Key = Interned_String;
+#else
+using Object_Key = std::string;
+#endif // BJSON_INTERNED_KEYS
+using Object_Compare = std::less<>;
+
+// Containers take a polymorphic allocator so a tree can be built inside an
+// arena, see Document. Default constructed ones use the default resource.
+#ifdef BJSON_FLAT_OBJECT
+using Object = Flat_Map<Object_Key,
+                        Value,
+                        Object_Compare,
+                        std::pmr::polymorphic_allocator<
+                            std::pair<const Object_Key, Value>>>;
+#else
+using Object = std::pmr::map<Object_Key, Value, Object_Compare>;
+#endif // BJSON_FLAT_OBJECT
+using Array = std::pmr::vector<Value>;
+
+// Packed storage of arrays holding only integers or only reals.
+using Int64_Array = std::pmr::vector<int64_t>;
+using Real_Array = std::pmr::vector<double>;
+
+/// \brief Contiguous run of elements, i.e. a minimal std::span.
+template <class T>
+class Span
+{
+public:
+    Span() = default;
+
+    Span(T* data, size_t size) : data_(data), size_(size)
+    {
+    }
+
+    T* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T* begin() const
+    {
+        return data_;
+    }
+
+    T* end() const
+    {
+        return data_ + size_;
+    }
+
+    T& operator[](size_t i) const
+    {
+        return data_[i];
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
 
 class Value
 {
 public:
+    /// Value is allocator aware, pmr containers pass their allocator when
+    /// they copy or emplace elements, so a nested copy ends up in the same
+    /// resource as its parent.
+    using allocator_type = std::pmr::polymorphic_allocator<Value>;
+
     Value();
     ~Value();
 
@@ -39,12 +132,25 @@ public:
     Value(const std::string& value);
     Value(std::string&& value);
 
+    /// \brief Box the string in \a mr, the characters themselves still
+    ///        belong to std::string.
+    Value(const char* value, std::pmr::memory_resource* mr);
+    Value(const std::string& value, std::pmr::memory_resource* mr);
+    Value(std::string&& value, std::pmr::memory_resource* mr);
+    Value(std::string_view value, std::pmr::memory_resource* mr);
+
     Value(const Object& value);
     Value(Object&& value);
 
     Value(const Array& value);
     Value(Array&& value);
 
+    /// \brief Packed arrays, type() is array_type.
+    ///
+    /// Non negative integers read back as uint64, as the parser makes them.
+    Value(Int64_Array&& value);
+    Value(Real_Array&& value);
+
     Value(bool value);
     Value(int value);
     Value(unsigned value);
@@ -61,26 +167,99 @@ public:
     template <class T>
     Value(const T*) = delete;
 
+    /// Boxes are shared by copies in the same resource, so a copy is O(1)
+    /// and a subtree is only cloned when one of the copies asks for a
+    /// mutable reference into it. Taking one, e.g. get_obj() on a non const
+    /// value, marks the box as referenced and later copies of it are deep,
+    /// until make_shareable().
     Value(const Value& other);
-    Value(Value&&);
+    Value(Value&&) noexcept;
+
+    /// \brief Deep copy \a other into \a mr.
+    ///
+    /// Example, build a response in a per request pool:
+    ///
+    /// std::pmr::unsynchronized_pool_resource pool;
+    /// Value resp{Object(&pool)};
+    /// resp.get_obj()["user"] = Value(cached_user, &pool);
+    Value(const Value& other, std::pmr::memory_resource* mr);
+
+    Value(std::allocator_arg_t, const allocator_type& alloc, const Value& other);
+    Value(std::allocator_arg_t, const allocator_type& alloc, Value& other);
+
+    /// A move steals the subtree whatever \a alloc is, the subtree keeps
+    /// the resource it was allocated from.
+    Value(std::allocator_arg_t, const allocator_type& alloc, Value&& other);
+
+    template <class... Args,
+              class = typename std::enable_if<
+                  std::is_constructible<Value, Args&&...>::value>::type>
+    Value(std::allocator_arg_t, const allocator_type& alloc, Args&&... args);
 
     Value& operator=(const Value& rhs);
     Value& operator=(Value&& rhs);
 
+    /// Values whose hashes are cached already and differ are told apart
+    /// without walking them, see hash().
     bool operator==(const Value& rhs) const;
 
     bool compare_only_value(const Value& rhs) const;
 
+    /// \brief Structural hash, equal values have equal hashes.
+    ///
+    /// The hash of an object, array or string is cached in its box unless
+    /// a mutable reference into it is out, so hashing a tree again costs
+    /// nothing, e.g. to tell whether a reloaded config changed.
+    size_t hash() const;
+
     Vtype type() const;
     bool is_null() const;
     bool is_uint64() const;
 
+    /// \brief Resource of the container or string, nullptr for scalars.
+    std::pmr::memory_resource* resource() const;
+
+    void swap(Value& rhs) noexcept;
+
+    /// \brief Let copies share this value again, after taking mutable
+    ///        references into it.
+    ///
+    /// Call it once no reference obtained from get_obj(), get_array(),
+    /// get_str() or the spans is used any more, the parser does it for
+    /// every container it completes.
+    /// \param deep also for every value below it.
+    void make_shareable(bool deep = false);
+
     Object& get_obj();
     const Object& get_obj() const;
 
+    /// A packed array is unpacked by the non const overload, the const one
+    /// returns a boxed copy made on first use. The copy stays valid until
+    /// the array is unpacked, destroyed or assigned, or make_shareable()
+    /// is called, writes through the spans do not end it.
     Array& get_array();
     const Array& get_array() const;
 
+    bool is_int64_array() const;
+    bool is_real_array() const;
+
+    /// \brief Raw buffer of a packed array, e.g. for vectorized math.
+    ///
+    /// The boxed copy of get_array() const is not updated by writes through
+    /// the non const overloads: they retire it, it keeps the values it had
+    /// for the references into it, and the next get_array() const makes a
+    /// new one.
+    Span<int64_t> get_int64_span();
+    Span<const int64_t> get_int64_span() const;
+
+    Span<double> get_real_span();
+    Span<const double> get_real_span() const;
+
+    /// \brief Switch an Array of only integers, or only reals, to packed
+    ///        storage in the same resource.
+    /// \return true if the array is packed afterwards.
+    bool pack_array();
+
     std::string& get_str();
     const std::string& get_str() const;
 
@@ -106,18 +285,130 @@ public:
     static const Value null;
 
 private:
-    using Variant = boost::variant<boost::recursive_wrapper<Object>,
-                                   boost::recursive_wrapper<Array>,
-                                   std::string,
-                                   bool,
-                                   int64_t,
-                                   uint64_t,
-                                   double,
-                                   Null_Fn>;
+    friend BJSON_EXPORT Memory_Usage memory_usage(const Value& value);
+
+    // Tags of scalars and boxed containers, the first ones share values
+    // with Vtype so type() is a plain load for everything but uint64.
+    enum Tag : uint8_t
+    {
+        obj_tag = obj_type,
+        array_tag = array_type,
+        str_tag = str_type,
+        bool_tag = bool_type,
+        int_tag = int_type,
+        real_tag = real_type,
+        null_tag = null_type,
+        uint_tag,
+        int_array_tag,
+        real_array_tag
+    };
+
+    // Reference count of a box, a referenced box has had a mutable
+    // reference into it taken, and is not shared by later copies.
+    struct Shared
+    {
+        std::atomic<uint32_t> refs{1};
+        bool referenced = false;
+
+        // Cached hash(), 0 until computed.
+        mutable std::atomic<size_t> hash{0};
+    };
+
+    template <class T>
+    struct Box : Shared
+    {
+        template <class... Args>
+        explicit Box(Args&&... args) : value(std::forward<Args>(args)...)
+        {
+        }
+
+        T value;
+    };
+
+    using Obj_Box = Box<Object>;
+    using Arr_Box = Box<Array>;
+
+    // Strings carry the resource their box came from, containers already
+    // know it through get_allocator().
+    struct Str_Box : Shared
+    {
+        template <class S>
+        Str_Box(std::pmr::memory_resource* m, S&& s)
+            : mr(m), str(std::forward<S>(s))
+        {
+        }
+
+        std::pmr::memory_resource* mr;
+        std::string str;
+    };
+
+    // A packed array and its boxed form for get_array() const, which is
+    // published once with a compare and swap so const readers may race.
+    // Boxed forms outdated by writes through a span are retired, not freed,
+    // references taken before the write may still be in use.
+    template <class T>
+    struct Packed_Box : Shared
+    {
+        explicit Packed_Box(std::pmr::vector<T>&& v)
+            : vec(std::move(v)),
+              retired(vec.get_allocator())
+        {
+        }
+
+        Packed_Box(const std::pmr::vector<T>& v, std::pmr::memory_resource* mr)
+            : vec(v, mr),
+              retired(mr)
+        {
+        }
+
+        std::pmr::vector<T> vec;
+        mutable std::atomic<Arr_Box*> boxed{nullptr};
+        std::pmr::vector<Arr_Box*> retired;
+    };
+
+    using Int64_Box = Packed_Box<int64_t>;
+    using Real_Box = Packed_Box<double>;
+
+    void destroy() noexcept;
+    void destroy_tree() noexcept;
+    void take_nested(std::vector<Value>& pending) noexcept;
+    void free_container() noexcept;
+
+    bool is_boxed() const;
+    Shared* shared() const;
+
+    // Own the box alone before handing out a mutable reference into it.
+    void own();
+    void unshare();
+    void clone_box(const Value& other, std::pmr::memory_resource* mr);
+
+    size_t cached_hash() const;
+    size_t compute_hash() const;
+
+    const Array& boxed_array() const;
+    Array& unpack_array();
 
     void check_type(const Vtype vtype) const;
 
-    Variant v_;
+    [[noreturn]] void throw_type_error(const Vtype vtype) const;
+
+    // Containers and strings live out of line, so every Value is a 8 bytes
+    // payload plus a tag, and an Array packs 16 bytes per element.
+    union Data
+    {
+        Obj_Box* obj;
+        Arr_Box* arr;
+        Str_Box* str;
+        Int64_Box* ints;
+        Real_Box* reals;
+        bool boolean;
+        int64_t i64;
+        uint64_t u64;
+        double real;
+    };
+
+    Data data_;
+    Tag tag_;
 };
 
 inline bool operator==(const Null_Fn&, const Null_Fn&)
@@ -125,6 +416,296 @@ inline bool operator==(const Null_Fn&, const Null_Fn&)
     return true;
 }
 
+inline Value::Value() : data_(), tag_(null_tag)
+{
+}
+
+inline Value::Value(bool value) : tag_(bool_tag)
+{
+    data_.boolean = value;
+}
+
+inline Value::Value(int value) : tag_(int_tag)
+{
+    data_.i64 = value;
+}
+
+inline Value::Value(unsigned value) : tag_(uint_tag)
+{
+    data_.u64 = value;
+}
+
+#if __SIZEOF_LONG__ == 4
+inline Value::Value(long value) : tag_(int_tag)
+{
+    data_.i64 = value;
+}
+
+inline Value::Value(unsigned long value) : tag_(uint_tag)
+{
+    data_.u64 = value;
+}
+#endif // __SIZEOF_LONG__ == 4
+
+inline Value::Value(int64_t value) : tag_(int_tag)
+{
+    data_.i64 = value;
+}
+
+inline Value::Value(uint64_t value) : tag_(uint_tag)
+{
+    data_.u64 = value;
+}
+
+inline Value::Value(double value) : tag_(real_tag)
+{
+    data_.real = value;
+}
+
+inline Value::Value(Value&& other) noexcept : data_(other.data_), tag_(other.tag_)
+{
+    other.tag_ = null_tag;
+}
+
+inline Value::Value(std::allocator_arg_t,
+                    const allocator_type& alloc,
+                    const Value& other)
+    : Value(other, alloc.resource())
+{
+}
+
+inline Value::Value(std::allocator_arg_t,
+                    const allocator_type& alloc,
+                    Value& other)
+    : Value(other, alloc.resource())
+{
+}
+
+inline Value::Value(std::allocator_arg_t,
+                    const allocator_type&,
+                    Value&& other)
+    : Value(std::move(other))
+{
+}
+
+template <class... Args, class>
+Value::Value(std::allocator_arg_t, const allocator_type& alloc, Args&&... args)
+    : Value(std::forward<Args>(args)...)
+{
+    const auto mr = resource();
+    if (mr && !mr->is_equal(*alloc.resource()))
+        *this = Value(*this, alloc.resource());
+}
+
+inline Value::~Value()
+{
+    if (is_boxed())
+        destroy();
+}
+
+inline bool Value::is_boxed() const
+{
+    return tag_ <= str_tag || tag_ >= int_array_tag;
+}
+
+inline Value::Shared* Value::shared() const
+{
+    switch (tag_) {
+    case obj_tag:
+        return data_.obj;
+    case array_tag:
+        return data_.arr;
+    case str_tag:
+        return data_.str;
+    case int_array_tag:
+        return data_.ints;
+    case real_array_tag:
+        return data_.reals;
+    default:
+        return nullptr;
+    }
+}
+
+inline void Value::own()
+{
+    if (shared()->refs.load(std::memory_order_acquire) != 1)
+        unshare();
+
+    shared()->referenced = true;
+    shared()->hash.store(0, std::memory_order_relaxed);
+}
+
+inline void Value::swap(Value& rhs) noexcept
+{
+    std::swap(data_, rhs.data_);
+    std::swap(tag_, rhs.tag_);
+}
+
+inline Vtype Value::type() const
+{
+    switch (tag_) {
+    case uint_tag:
+        return int_type;
+    case int_array_tag:
+    case real_array_tag:
+        return array_type;
+    default:
+        return static_cast<Vtype>(tag_);
+    }
+}
+
+inline bool Value::is_null() const
+{
+    return tag_ == null_tag;
+}
+
+inline bool Value::is_uint64() const
+{
+    return tag_ == uint_tag;
+}
+
+inline void Value::check_type(const Vtype vtype) const
+{
+    if (type() != vtype)
+        throw_type_error(vtype);
+}
+
+inline Object& Value::get_obj()
+{
+    check_type(obj_type);
+    own();
+    return data_.obj->value;
+}
+
+inline const Object& Value::get_obj() const
+{
+    check_type(obj_type);
+    return data_.obj->value;
+}
+
+inline Array& Value::get_array()
+{
+    if (tag_ == array_tag) {
+        own();
+        return data_.arr->value;
+    }
+
+    check_type(array_type);
+    return unpack_array();
+}
+
+inline const Array& Value::get_array() const
+{
+    if (tag_ == array_tag)
+        return data_.arr->value;
+
+    check_type(array_type);
+    return boxed_array();
+}
+
+inline bool Value::is_int64_array() const
+{
+    return tag_ == int_array_tag;
+}
+
+inline bool Value::is_real_array() const
+{
+    return tag_ == real_array_tag;
+}
+
+inline std::string& Value::get_str()
+{
+    check_type(str_type);
+    own();
+    return data_.str->str;
+}
+
+inline const std::string& Value::get_str() const
+{
+    check_type(str_type);
+    return data_.str->str;
+}
+
+inline bool Value::get_bool() const
+{
+    check_type(bool_type);
+    return data_.boolean;
+}
+
+inline int Value::get_int() const
+{
+    return static_cast<int>(get_int64());
+}
+
+inline unsigned Value::get_uint() const
+{
+    return static_cast<unsigned>(get_uint64());
+}
+
+inline long Value::get_long() const
+{
+    return static_cast<long>(get_int64());
+}
+
+inline unsigned long Value::get_ulong() const
+{
+    return static_cast<unsigned long>(get_uint64());
+}
+
+inline int64_t Value::get_int64() const
+{
+    check_type(int_type);
+    return tag_ == uint_tag ? static_cast<int64_t>(data_.u64) : data_.i64;
+}
+
+inline uint64_t Value::get_uint64() const
+{
+    check_type(int_type);
+    return tag_ == uint_tag ? data_.u64 : static_cast<uint64_t>(data_.i64);
+}
+
+inline double Value::get_real() const
+{
+    switch (tag_) {
+    case real_tag:
+        return data_.real;
+    case int_tag:
+        return static_cast<double>(data_.i64);
+    case uint_tag:
+        return static_cast<double>(data_.u64);
+    default:
+        throw_type_error(real_type);
+    }
+}
+
+inline Object& Value::to_object()
+{
+    return tag_ == obj_tag ? get_obj() : to_new_object();
+}
+
+inline Array& Value::to_array()
+{
+    return type() == array_type ? get_array() : to_new_array();
+}
+
+inline size_t hash(const Value& value)
+{
+    return value.hash();
+}
+
+}
+
+namespace std {
+
+template <>
+struct hash<bjson::Value>
+{
+    size_t operator()(const bjson::Value& value) const
+    {
+        return value.hash();
+    }
+};
+
 }
 
 #endif
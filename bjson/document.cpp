@@ -0,0 +1,66 @@
+#include "document.h"
+#include "load.h"
+
+namespace bjson {
+
+static size_t first_chunk_size(size_t initial_size)
+{
+    return initial_size ? initial_size : 64 * 1024;
+}
+
+Document::Document(size_t initial_size, int flags)
+    : arena_(first_chunk_size(initial_size),
+             flags & FG_HUGE_PAGES ? static_cast<std::pmr::memory_resource*>(&huge_pages_)
+                                   : std::pmr::new_delete_resource())
+{
+}
+
+Document::~Document()
+{
+    clear();
+}
+
+bool Document::parse(const char* str, size_t len, int flags)
+{
+    clear();
+    if (loads_json(str, len, root_, &arena_, flags))
+        return true;
+
+    clear();
+    return false;
+}
+
+bool Document::load(const char* path, int flags)
+{
+    clear();
+    if (load_json(path, root_, &arena_, flags))
+        return true;
+
+    clear();
+    return false;
+}
+
+Value& Document::root()
+{
+    return root_;
+}
+
+const Value& Document::root() const
+{
+    return root_;
+}
+
+std::pmr::memory_resource* Document::resource()
+{
+    return &arena_;
+}
+
+void Document::clear()
+{
+    // Destructors of the tree still run for the long strings, while the
+    // deallocations of boxes and containers are no-ops of the arena.
+    root_ = Value();
+    arena_.release();
+}
+
+} // namespace bjson
@@ -0,0 +1,70 @@
+/// \file document.h
+/// \brief JSON document whose value tree lives in a monotonic arena.
+#ifndef BJSON_DOCUMENT_H
+#define BJSON_DOCUMENT_H
+
+#include "bjson_export.h"
+#include "bjson_value.h"
+#include "huge_page_resource.h"
+#include "json_reader.h"
+
+#include <memory_resource>
+
+namespace bjson {
+
+/// \brief Owner of a parsed tree and of the arena it was built in.
+///
+/// Every container, and the box of every string, is bump allocated from
+/// the arena, so parsing does no per node malloc and dropping the tree
+/// frees a handful of chunks. Only the characters of strings too long for
+/// the small string buffer still come from the global heap.
+///
+/// root() is an ordinary Value, JSON_Pointer and extract() work on it.
+/// Copies of its subtrees are allocated from the default resource, but a
+/// Value moved out still points into the arena and must not outlive the
+/// document.
+///
+/// Example:
+///
+/// Document doc(64 * 1024, Document::FG_HUGE_PAGES);
+/// if (doc.load("/path/to/big.json"))
+///     extract(doc.root().get_obj())("name", name);
+class BJSON_EXPORT Document
+{
+public:
+    enum Flag {
+        FG_HUGE_PAGES = (1 << 0)
+    };
+
+    /// \param initial_size size of the first arena chunk, 0 for default.
+    /// \param flags Flag values.
+    explicit Document(size_t initial_size = 0, int flags = 0);
+    ~Document();
+
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+    /// \brief Parse \a str into the arena, replacing the previous tree.
+    bool parse(const char* str, size_t len, int flags = JSON_Reader::FG_LOGGING);
+
+    /// \brief Parse the file at \a path into the arena.
+    bool load(const char* path, int flags = JSON_Reader::FG_LOGGING);
+
+    Value& root();
+    const Value& root() const;
+
+    /// \brief The arena, to build values that are inserted into root().
+    std::pmr::memory_resource* resource();
+
+    /// \brief Drop the tree and give the arena chunks back.
+    void clear();
+
+private:
+    Huge_Page_Resource huge_pages_;
+    std::pmr::monotonic_buffer_resource arena_;
+    Value root_;
+};
+
+} // namespace bjson
+
+#endif // BJSON_DOCUMENT_H
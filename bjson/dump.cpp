@@ -3,13 +3,11 @@
 #   include "dump.inl"
 #endif /* __ACE_INLINE__ */
 
-#include "json_writer.h"
-#include "scrt/yajl_ostream_printer.h"
-#include "scrt/yajl_file_printer.h"
+#include "text_writer.h"
 #include <ace/Log_Msg.h>
+#include <ace/OS_NS_fcntl.h>
 #include <ace/OS_NS_string.h>
 #include <ace/OS_NS_unistd.h>
-#include <sstream>
 
 using json_spirit::Value;
 using namespace std;
@@ -18,17 +16,23 @@ DEFAULT_DTOR_DEFINE(JSON_Dump)
 
 JSON_Dump::JSON_Dump(const Value& json, bool beautify)
 {
-    stringstream ss;
-    YAJL_OStream_Printer printer;
-    if (printer.open(&ss)) {
-        JSON_Writer writer;
-        if (!writer.write(json, printer, beautify))
-            ACE_ERROR((LM_ERROR, "Failed to dump json object\n"));
-    } else {
-        ACE_ERROR((LM_ERROR, "Failed to open YAJL_OStream_Printer\n"));
-    }
-
-    val_ = ss.str();
+    bjson::write_json(json, val_, beautify);
+}
+
+void JSON_Dump::dump(const Value& json, bool beautify)
+{
+    val_.clear();
+    bjson::write_json(json, val_, beautify);
+}
+
+void dumps_json(const Value& json, string& out, bool beautify)
+{
+    bjson::write_json(json, out, beautify);
+}
+
+void dumps_json(const Value& json, vector<char>& out, bool beautify)
+{
+    bjson::write_json(json, out, beautify);
 }
 
 bool dump_json(const char* path,
@@ -39,11 +43,15 @@ bool dump_json(const char* path,
 {
     ACE_OS::unlink(path);
 
-    YAJL_File_Printer printer;
-    if (!printer.open(path, flags, perms))
+    ACE_HANDLE handle = ACE_OS::open(path,
+                                     O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | flags,
+                                     perms);
+    if (handle == ACE_INVALID_HANDLE)
         return false;
 
-    if (!JSON_Writer().write(json, printer, beautify))
+    const bool ok = bjson::write_json(json, handle, beautify);
+    ACE_OS::close(handle);
+    if (!ok)
         ACE_ERROR_RETURN((LM_ERROR,
                           "Failed to write json to '%C'\n",
                           path),
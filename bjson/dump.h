@@ -5,14 +5,23 @@
 #include "json_spirit_value.h"
 #include "scrt/ctor_dtor_macros.h"
 
+#include <string>
+#include <vector>
+
 class JSON_SPIRIT_Export JSON_Dump
 {
 public:
     using size_type = std::string::size_type;
 
+    JSON_Dump() = default;
     JSON_Dump(const json_spirit::Value& json, bool beautify = false);
     DEFAULT_DTOR_DECLARE(JSON_Dump);
 
+    /// \brief Replace the text with the one of \a json, in the buffer of
+    ///        the previous text. A JSON_Dump kept across requests stops
+    ///        allocating once it holds the largest text.
+    void dump(const json_spirit::Value& json, bool beautify = false);
+
     const std::string& str() const;
     const char* c_str() const;
     size_type size() const;
@@ -20,6 +29,19 @@ protected:
     std::string val_;
 };
 
+/// \brief Append the text of \a json to \a out.
+///
+/// \a out is owned by the caller and may be reused: cleared between calls
+/// it keeps its capacity, and nothing is allocated once that fits the text.
+JSON_SPIRIT_Export void dumps_json(const json_spirit::Value& json,
+                                   std::string& out,
+                                   bool beautify = false);
+
+/// \copydoc dumps_json(const json_spirit::Value&, std::string&, bool)
+JSON_SPIRIT_Export void dumps_json(const json_spirit::Value& json,
+                                   std::vector<char>& out,
+                                   bool beautify = false);
+
 /// \brief write json to file
 /// \param path path to write the json
 /// \param json json to dump
@@ -136,7 +136,7 @@ struct JSON_Pointer_Extractor: public Flaggable_T<JSON_Pointer_Extractor<T>>
     }
 
     template <typename U>
-    JSON_Pointer_Extractor& operator()(const String_type& name,
+    JSON_Pointer_Extractor& operator()(std::string_view name,
                                        U& val,
                                        Flags flags)
     {
@@ -145,23 +145,23 @@ struct JSON_Pointer_Extractor: public Flaggable_T<JSON_Pointer_Extractor<T>>
                       "JSON_Pointer_Extractor: forbidden to extract a pointer "
                       "from a rvalue JSON!");
 
-        pointer.path(name.c_str(), false);
+        pointer.path(name);
         if (!pointer.get(std::forward<T>(doc), val) && (flags & FG_THROW))
-            throw std::domain_error("JSON Pointer path '" +
-                                        name +
-                                        "' not exist in JSON!");
+            throw std::domain_error(std::string("JSON Pointer path '")
+                                        .append(name)
+                                        .append("' not exist in JSON!"));
 
         return *this;
     }
 
     template <typename U>
-    JSON_Pointer_Extractor& operator()(const String_type& name, U& val)
+    JSON_Pointer_Extractor& operator()(std::string_view name, U& val)
     {
         return (*this)(name, val, flags_);
     }
 
     template <typename U>
-    JSON_Pointer_Extractor& operator()(const String_type& name,
+    JSON_Pointer_Extractor& operator()(std::string_view name,
                                        OPT_NS::optional<U>& val,
                                        Flags flags)
     {
@@ -169,18 +169,18 @@ struct JSON_Pointer_Extractor: public Flaggable_T<JSON_Pointer_Extractor<T>>
                       "JSON_Pointer_Extractor: forbidden to extract "
                       "a OPT_NS::optional<U>, when U is a reference!");
 
-        pointer.path(name.c_str(), false);
+        pointer.path(name);
         val = pointer.get<U>(std::forward<T>(doc));
         if (!val && (flags & FG_THROW))
-            throw std::domain_error("JSON Pointer path '" +
-                                        name +
-                                        "' not exist in JSON!");
+            throw std::domain_error(std::string("JSON Pointer path '")
+                                        .append(name)
+                                        .append("' not exist in JSON!"));
 
         return *this;
     }
 
     template <typename U>
-    JSON_Pointer_Extractor& operator()(const String_type& name,
+    JSON_Pointer_Extractor& operator()(std::string_view name,
                                        OPT_NS::optional<U>& val)
     {
         return (*this)(name, val, flags_);
@@ -193,7 +193,7 @@ struct JSON_Pointer_Extractor: public Flaggable_T<JSON_Pointer_Extractor<T>>
 
 template <typename T>
 void object_get_may_throw(
-        const Object& obj, const String_type& name, T& val, bool throw_)
+        const Object& obj, const Key& name, T& val, bool throw_)
 {
     if (throw_)
         val = std::is_signed<T>::value
@@ -212,7 +212,7 @@ struct Object_Extractor_Base
     }
 
 #define CONST_OBJECT_EXTRACT_R(type, helper) \
-    Object_Extractor_Base& operator()(const String_type& name, \
+    Object_Extractor_Base& operator()(const Key& name, \
                                       type& val, \
                                       Flags flags) \
     { \
@@ -224,7 +224,7 @@ struct Object_Extractor_Base
         return *this; \
     } \
 \
-    Object_Extractor_Base& operator()(const String_type& name, type& val) \
+    Object_Extractor_Base& operator()(const Key& name, type& val) \
     { \
         return (*this)(name, val, flags_); \
     }
@@ -241,7 +241,7 @@ struct Object_Extractor_Base
     // For numeric types
     template <typename T,
               typename std::enable_if<is_arithmetic_or_enum<T>::value, int>::type = 0>
-    Object_Extractor_Base& operator()(const String_type& name,
+    Object_Extractor_Base& operator()(const Key& name,
                                       T& val,
                                       Flags flags)
     {
@@ -252,7 +252,7 @@ struct Object_Extractor_Base
     // For types assignable from non-arithmetic json types
     template <typename T,
               typename std::enable_if<is_assignable_from_json_types<T>::value, int>::type = 0>
-    Object_Extractor_Base& operator()(const String_type& name,
+    Object_Extractor_Base& operator()(const Key& name,
                                       T& val,
                                       Flags flags)
     {
@@ -263,13 +263,13 @@ struct Object_Extractor_Base
     }
 
     template <typename T>
-    Object_Extractor_Base& operator()(const String_type& name, T& val)
+    Object_Extractor_Base& operator()(const Key& name, T& val)
     {
         return (*this)(name, val, flags_);
     }
 
 #define CONST_OBJECT_EXTRACT_P(type, helper) \
-    Object_Extractor_Base& operator()(const String_type& name, \
+    Object_Extractor_Base& operator()(const Key& name, \
                                       const type*& val, \
                                       Flags flags) \
     { \
@@ -278,7 +278,7 @@ struct Object_Extractor_Base
         return *this; \
     } \
 \
-    Object_Extractor_Base& operator()(const String_type& name, \
+    Object_Extractor_Base& operator()(const Key& name, \
                                       const type*& val) \
     { \
         return (*this)(name, val, flags_); \
@@ -291,7 +291,7 @@ struct Object_Extractor_Base
     CONST_OBJECT_EXTRACT_P(Value, object_get_value)
 
     // Get c_str() of String_type
-    Object_Extractor_Base& operator()(const String_type& name,
+    Object_Extractor_Base& operator()(const Key& name,
                                       const char*& val,
                                       Flags flags)
     {
@@ -301,14 +301,14 @@ struct Object_Extractor_Base
         return *this;
     }
 
-    Object_Extractor_Base& operator()(const String_type& name,
+    Object_Extractor_Base& operator()(const Key& name,
                                       const char*& val)
     {
         return (*this)(name, val, flags_);
     }
 
     // Copy to char array from String_type
-    Object_Extractor_Base& operator()(const String_type& name,
+    Object_Extractor_Base& operator()(const Key& name,
                                       char* val,
                                       size_t maxlen,
                                       Flags flags)
@@ -319,7 +319,7 @@ struct Object_Extractor_Base
         return *this;
     }
 
-    Object_Extractor_Base& operator()(const String_type& name,
+    Object_Extractor_Base& operator()(const Key& name,
                                       char* val,
                                       size_t maxlen)
     {
@@ -364,24 +364,25 @@ struct Object_Extractor
     : public Object_Extractor_Base, Flaggable_T<Object_Extractor>
 {
     Object_Extractor(Object& obj, Flags flags = 0u)
-        : Object_Extractor_Base(obj, flags)
+        : Object_Extractor_Base(obj, flags),
+          mutable_obj(obj)
     {
     }
 
     using Object_Extractor_Base::operator();
 
 #define OBJECT_EXTRACT_P(type, helper) \
-    Object_Extractor& operator()(const String_type& name, \
+    Object_Extractor& operator()(const Key& name, \
                                  type* &val, \
                                  Flags flags) \
     { \
         val = flags & FG_THROW \
-                  ? &helper ## _or_throw(const_cast<Object&>(obj), name) \
-                  : helper(const_cast<Object&>(obj), name); \
+                  ? &helper ## _or_throw(mutable_obj, name) \
+                  : helper(mutable_obj, name); \
         return *this; \
     } \
 \
-    Object_Extractor& operator()(const String_type& name, type* &val) \
+    Object_Extractor& operator()(const Key& name, type* &val) \
     { \
         return (*this)(name, val, flags_); \
     }
@@ -391,6 +392,9 @@ struct Object_Extractor
     OBJECT_EXTRACT_P(Array, object_get_array)
     OBJECT_EXTRACT_P(Object, object_get_object)
     OBJECT_EXTRACT_P(Value, object_get_value)
+
+    // The non const accessors unshare what a copy of the document shares.
+    Object& mutable_obj;
 };
 
 /**
@@ -415,22 +419,21 @@ struct Object_Move_Extractor: public Flaggable_T<Object_Move_Extractor>
 
     // For string, Object, Array, Value
 #define OBJECT_MOVE_EXTRACT(type, helper) \
-    Object_Move_Extractor& operator()(const String_type& name, \
+    Object_Move_Extractor& operator()(const Key& name, \
                                       type& val, \
                                       Flags flags) \
     { \
         if (flags & FG_THROW) { \
-            auto& tmp = helper ## _or_throw(obj, name); \
-            val = std::move(const_cast<type&>(tmp)); \
+            val = std::move(helper ## _or_throw(obj, name)); \
         } else { \
             if (auto p = helper(obj, name)) \
-                val = std::move(*const_cast<type*>(p)); \
+                val = std::move(*p); \
         } \
 \
         return *this; \
     } \
 \
-    Object_Move_Extractor& operator()(const String_type& name, type& val) \
+    Object_Move_Extractor& operator()(const Key& name, type& val) \
     { \
         return (*this)(name, val, flags_); \
     }
@@ -442,7 +445,7 @@ struct Object_Move_Extractor: public Flaggable_T<Object_Move_Extractor>
     OBJECT_MOVE_EXTRACT(Value, object_get_value)
 
     // bool should not be handled by the following template function.
-    Object_Move_Extractor& operator()(const String_type& name,
+    Object_Move_Extractor& operator()(const Key& name,
                                       bool& val,
                                       Flags flags)
     {
@@ -454,7 +457,7 @@ struct Object_Move_Extractor: public Flaggable_T<Object_Move_Extractor>
         return *this;
     }
 
-    Object_Move_Extractor& operator()(const String_type& name, bool& val)
+    Object_Move_Extractor& operator()(const Key& name, bool& val)
     {
         return (*this)(name, val, flags_);
     }
@@ -462,7 +465,7 @@ struct Object_Move_Extractor: public Flaggable_T<Object_Move_Extractor>
     // For numeric types
     template <typename T,
               typename std::enable_if<is_arithmetic_or_enum<T>::value, int>::type = 0>
-    Object_Move_Extractor& operator()(const String_type& name,
+    Object_Move_Extractor& operator()(const Key& name,
                                       T& val,
                                       Flags flags)
     {
@@ -473,7 +476,7 @@ struct Object_Move_Extractor: public Flaggable_T<Object_Move_Extractor>
     // For types assignable from non-arithmetic json types
     template <typename T,
               typename std::enable_if<is_assignable_from_json_types<T>::value, int>::type = 0>
-    Object_Move_Extractor& operator()(const String_type& name,
+    Object_Move_Extractor& operator()(const Key& name,
                                       T& val,
                                       Flags flags)
     {
@@ -484,7 +487,7 @@ struct Object_Move_Extractor: public Flaggable_T<Object_Move_Extractor>
     }
 
     template <typename T>
-    Object_Move_Extractor& operator()(const String_type& name, T& val)
+    Object_Move_Extractor& operator()(const Key& name, T& val)
     {
         return (*this)(name, val, flags_);
     }
@@ -550,64 +553,64 @@ pextract_or_throw(T&& doc)
 
 template<typename T,
          typename std::enable_if<!is_arithmetic_or_enum<T>::value, int>::type = 0>
-T& object_get_any(const Object& obj, const String_type& name);
+T& object_get_any(const Object& obj, const Key& name);
 
 template<typename T>
-T& object_get_any(Object& obj, const String_type& name)
+T& object_get_any(Object& obj, const Key& name)
 {
     return object_get_any<const T>((const Object&) obj, name);
 }
 
 template<>
 inline const String_type& object_get_any<const String_type>(
-        const Object& obj, const String_type& name)
+        const Object& obj, const Key& name)
 {
     return object_get_str_or_throw(obj, name);
 }
 
 template<>
 inline const secure_string& object_get_any<const secure_string>(
-        const Object& obj, const String_type& name)
+        const Object& obj, const Key& name)
 {
     return object_get_secure_str_or_throw(obj, name);
 }
 
 template<>
 inline const Array& object_get_any<const Array>(
-        const Object& obj, const String_type& name)
+        const Object& obj, const Key& name)
 {
     return object_get_array_or_throw(obj, name);
 }
 
 template<>
 inline const Object& object_get_any<const Object>(
-        const Object& obj, const String_type& name)
+        const Object& obj, const Key& name)
 {
     return object_get_object_or_throw(obj, name);
 }
 
 template<>
 inline const Value& object_get_any<const Value>(
-        const Object& obj, const String_type& name)
+        const Object& obj, const Key& name)
 {
     return object_get_value_or_throw(obj, name);
 }
 
 template<>
-inline Array& object_get_any<Array>(Object& obj, const String_type& name)
+inline Array& object_get_any<Array>(Object& obj, const Key& name)
 {
     return object_get_array_or_throw(obj, name);
 }
 
 template<>
-inline Object& object_get_any<Object>(Object& obj, const String_type& name)
+inline Object& object_get_any<Object>(Object& obj, const Key& name)
 {
     return object_get_object_or_throw(obj, name);
 }
 
 // These two enable extract_object_ptr to be used in if clause
 template<typename T>
-T* object_get_any_ptr(const Object& obj, const String_type& name)
+T* object_get_any_ptr(const Object& obj, const Key& name)
 {
     T* p;
     extract(obj)(name, p);
@@ -615,7 +618,7 @@ T* object_get_any_ptr(const Object& obj, const String_type& name)
 }
 
 template<typename T>
-T* object_get_any_ptr(Object& obj, const String_type& name)
+T* object_get_any_ptr(Object& obj, const Key& name)
 {
     T* p;
     extract(obj)(name, p);
@@ -624,7 +627,7 @@ T* object_get_any_ptr(Object& obj, const String_type& name)
 
 template<typename T>
 T object_get_or_default(
-        const Object& obj, const String_type& name, const T& default_)
+        const Object& obj, const Key& name, const T& default_)
 {
     T val;
     return object_get(obj, name, val) ? val : default_;
@@ -26,7 +26,10 @@ struct Type_Checker
         return v.type() == type;
     }
 
-    bool operator()(const Object::value_type &v) const
+    // Takes any pair like reference, Object::reference of a flat Object is
+    // a proxy, binding it to 'const Object::value_type&' would copy it.
+    template <class Pair>
+    bool operator()(const Pair &v) const
     {
         return v.second.type() == type;
     }
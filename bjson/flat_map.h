@@ -0,0 +1,838 @@
+/// \file flat_map.h
+/// \brief Sorted vector based associative container with std::map like API.
+///
+/// Keys and mapped values are kept in two parallel vectors ordered by key,
+/// so a lookup only walks the contiguous key array and an object costs two
+/// allocations instead of one tree node per member.
+///
+/// The key array is reference counted and copied on write, so copies of a
+/// map, or maps built with share_keys(), keep one key array between them
+/// like the hidden classes of JavaScript engines, and each map only owns a
+/// dense vector of mapped values.
+///
+/// Unlike std::map, iterators and references are invalidated by insertion
+/// and erasure, and dereferencing an iterator yields a proxy pair of
+/// references, i.e. use `const auto&` or `auto&&` in range based for loops.
+#ifndef BJSON_FLAT_MAP_H
+#define BJSON_FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bjson {
+
+template <class Key,
+          class T,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class Flat_Map
+{
+    template <class U>
+    using rebind_alloc =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key&, T&>;
+    using const_reference = std::pair<const Key&, const T&>;
+    using key_container_type = std::vector<Key, rebind_alloc<Key>>;
+    using mapped_container_type = std::vector<T, rebind_alloc<T>>;
+
+    template <bool Const>
+    class Iterator
+    {
+        using mapped_ptr = typename std::conditional<Const, const T*, T*>::type;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Flat_Map::value_type;
+        using difference_type = Flat_Map::difference_type;
+        using reference = typename std::conditional<
+            Const, Flat_Map::const_reference, Flat_Map::reference>::type;
+
+        struct pointer
+        {
+            const reference* operator->() const
+            {
+                return &ref;
+            }
+
+            reference ref;
+        };
+
+        Iterator() = default;
+
+        Iterator(const Key* key, mapped_ptr val) : key_(key), val_(val)
+        {
+        }
+
+        template <bool C, class = typename std::enable_if<Const && !C>::type>
+        Iterator(const Iterator<C>& rhs) : key_(rhs.key_), val_(rhs.val_)
+        {
+        }
+
+        reference operator*() const
+        {
+            return reference(*key_, *val_);
+        }
+
+        pointer operator->() const
+        {
+            return pointer{**this};
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return reference(key_[n], val_[n]);
+        }
+
+        Iterator& operator++()
+        {
+            ++key_;
+            ++val_;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        Iterator& operator--()
+        {
+            --key_;
+            --val_;
+            return *this;
+        }
+
+        Iterator operator--(int)
+        {
+            Iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        Iterator& operator+=(difference_type n)
+        {
+            key_ += n;
+            val_ += n;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type n)
+        {
+            key_ -= n;
+            val_ -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator i, difference_type n)
+        {
+            return i += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator i)
+        {
+            return i += n;
+        }
+
+        friend Iterator operator-(Iterator i, difference_type n)
+        {
+            return i -= n;
+        }
+
+        friend difference_type operator-(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ - b.key_;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ == b.key_;
+        }
+
+        friend bool operator!=(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ != b.key_;
+        }
+
+        friend bool operator<(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ < b.key_;
+        }
+
+        friend bool operator>(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ > b.key_;
+        }
+
+        friend bool operator<=(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ <= b.key_;
+        }
+
+        friend bool operator>=(const Iterator& a, const Iterator& b)
+        {
+            return a.key_ >= b.key_;
+        }
+
+    private:
+        friend class Flat_Map;
+        friend class Iterator<!Const>;
+
+        const Key* key_ = nullptr;
+        mapped_ptr val_ = nullptr;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    Flat_Map() = default;
+
+    explicit Flat_Map(const Allocator& alloc)
+        : values_(rebind_alloc<T>(alloc))
+    {
+    }
+
+    Flat_Map(std::initializer_list<value_type> il,
+             const Allocator& alloc = Allocator())
+        : Flat_Map(alloc)
+    {
+        insert(il.begin(), il.end());
+    }
+
+    template <class InputIt>
+    Flat_Map(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : Flat_Map(alloc)
+    {
+        insert(first, last);
+    }
+
+    Flat_Map(const Flat_Map& rhs)
+        : Flat_Map(rhs,
+                   alloc_traits::select_on_container_copy_construction(
+                       rhs.get_allocator()))
+    {
+    }
+
+    Flat_Map(Flat_Map&&) = default;
+
+    // The key array is only shared between maps of equal allocators, it
+    // must not outlive the resource it was allocated from.
+    Flat_Map(const Flat_Map& rhs, const Allocator& alloc)
+        : shape_(alloc == rhs.get_allocator()
+                     ? rhs.shape_
+                     : copy_shape(rhs.keys(), alloc)),
+          values_(rhs.values_, rebind_alloc<T>(alloc)),
+          comp_(rhs.comp_)
+    {
+    }
+
+    Flat_Map(Flat_Map&& rhs, const Allocator& alloc)
+        : shape_(alloc == rhs.get_allocator()
+                     ? std::move(rhs.shape_)
+                     : copy_shape(rhs.keys(), alloc)),
+          values_(std::move(rhs.values_), rebind_alloc<T>(alloc)),
+          comp_(rhs.comp_)
+    {
+        rhs.clear();
+    }
+
+    Flat_Map& operator=(const Flat_Map& rhs)
+    {
+        if (this != &rhs) {
+            Flat_Map tmp(rhs,
+                         alloc_traits::propagate_on_container_copy_assignment::value
+                             ? rhs.get_allocator()
+                             : get_allocator());
+            swap(tmp);
+        }
+
+        return *this;
+    }
+
+    Flat_Map& operator=(Flat_Map&& rhs)
+    {
+        if (this != &rhs) {
+            const Allocator alloc =
+                alloc_traits::propagate_on_container_move_assignment::value
+                    ? rhs.get_allocator()
+                    : get_allocator();
+            Flat_Map tmp(std::move(rhs), alloc);
+            swap(tmp);
+        }
+
+        return *this;
+    }
+
+    Flat_Map& operator=(std::initializer_list<value_type> il)
+    {
+        clear();
+        insert(il.begin(), il.end());
+        return *this;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(values_.get_allocator());
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(keys().data(), values_.data());
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(keys().data(), values_.data());
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    iterator end() noexcept
+    {
+        return begin() + size();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return begin() + size();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const noexcept
+    {
+        return values_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return values_.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return values_.max_size();
+    }
+
+    size_type capacity() const noexcept
+    {
+        return values_.capacity();
+    }
+
+    void reserve(size_type n)
+    {
+        if (n > size())
+            own_keys().reserve(n);
+
+        values_.reserve(n);
+    }
+
+    void shrink_to_fit()
+    {
+        if (shape_ && shape_.use_count() == 1)
+            shape_->shrink_to_fit();
+
+        values_.shrink_to_fit();
+    }
+
+    void clear() noexcept
+    {
+        shape_.reset();
+        values_.clear();
+    }
+
+    /// \brief Read only access to the sorted key array.
+    const key_container_type& keys() const noexcept
+    {
+        return shape_ ? *shape_ : empty_keys();
+    }
+
+    /// \brief Use the key array of \a other if both maps have the same
+    ///        keys, e.g. sibling records of an array.
+    /// \return true if the maps share their key array afterwards.
+    bool share_keys(const Flat_Map& other)
+    {
+        if (shape_ == other.shape_)
+            return true;
+
+        if (!shape_ || !other.shape_ || get_allocator() != other.get_allocator())
+            return false;
+
+        if (*shape_ != *other.shape_)
+            return false;
+
+        shape_ = other.shape_;
+        return true;
+    }
+
+    /// \brief Replace the content by the \a n members at \a keys and
+    ///        \a values, in any order, moving from them.
+    ///
+    /// A later duplicate of a key replaces the earlier one, as operator[]
+    /// does. Each array is allocated once at its final size, and the key
+    /// array of \a like is used instead if it holds the same keys, see
+    /// share_keys().
+    template <class KeyIt, class ValueIt>
+    void assign_unsorted(KeyIt keys,
+                         ValueIt values,
+                         size_type n,
+                         const Flat_Map* like = nullptr)
+    {
+        // Members in key order, records are small enough for the stack.
+        size_type local[32];
+        std::vector<size_type> heap;
+        size_type* order = local;
+        if (n > 32) {
+            heap.resize(n);
+            order = heap.data();
+        }
+
+        for (size_type i = 0; i < n; ++i)
+            order[i] = i;
+
+        const auto less = [&](size_type a, size_type b) {
+            return comp_(keys[a], keys[b]);
+        };
+
+        if (!std::is_sorted(order, order + n, less))
+            std::stable_sort(order, order + n, less);
+
+        // Equal keys are adjacent in input order, keep the last one.
+        size_type m = 0;
+        for (size_type i = 0; i < n; ++i) {
+            if (m && !less(order[m - 1], order[i]))
+                --m;
+
+            order[m++] = order[i];
+        }
+
+        const Allocator alloc = get_allocator();
+        if (like && like->shape_ && like->size() == m &&
+            like->get_allocator() == alloc &&
+            std::equal(order, order + m, like->shape_->begin(),
+                       [&](size_type i, const Key& k) { return keys[i] == k; })) {
+            shape_ = like->shape_;
+        } else if (m) {
+            auto k = key_container_type(rebind_alloc<Key>(alloc));
+            k.reserve(m);
+            for (size_type i = 0; i < m; ++i)
+                k.push_back(std::move(keys[order[i]]));
+
+            shape_ = make_shape(alloc, std::move(k));
+        } else {
+            shape_.reset();
+        }
+
+        values_.clear();
+        values_.reserve(m);
+        for (size_type i = 0; i < m; ++i)
+            values_.push_back(std::move(values[order[i]]));
+    }
+
+    /// \brief Whether the key array is shared with \a other.
+    bool shares_keys(const Flat_Map& other) const noexcept
+    {
+        return shape_ && shape_ == other.shape_;
+    }
+
+    /// \brief Access to the mapped values, in the same order as keys().
+    const mapped_container_type& values() const noexcept
+    {
+        return values_;
+    }
+
+    T& operator[](const Key& key)
+    {
+        return values_[try_emplace(key).first.val_ - values_.data()];
+    }
+
+    T& operator[](Key&& key)
+    {
+        return values_[try_emplace(std::move(key)).first.val_ - values_.data()];
+    }
+
+    T& at(const Key& key)
+    {
+        const auto i = find(key);
+        if (i == end())
+            throw std::out_of_range("Flat_Map::at: key not found");
+
+        return *i.val_;
+    }
+
+    const T& at(const Key& key) const
+    {
+        const auto i = find(key);
+        if (i == end())
+            throw std::out_of_range("Flat_Map::at: key not found");
+
+        return *i.val_;
+    }
+
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+    {
+        const size_type pos = lower_bound_index(key);
+        if (pos < size() && !comp_(key, keys()[pos]))
+            return {make_iterator(pos), false};
+
+        emplace_at(pos, std::forward<K>(key), std::forward<Args>(args)...);
+        return {make_iterator(pos), true};
+    }
+
+    template <class K, class... Args>
+    iterator try_emplace(const_iterator, K&& key, Args&&... args)
+    {
+        return try_emplace(std::forward<K>(key),
+                           std::forward<Args>(args)...).first;
+    }
+
+    template <class K, class M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& val)
+    {
+        const size_type pos = lower_bound_index(key);
+        if (pos < size() && !comp_(key, keys()[pos])) {
+            values_[pos] = std::forward<M>(val);
+            return {make_iterator(pos), false};
+        }
+
+        emplace_at(pos, std::forward<K>(key), std::forward<M>(val));
+        return {make_iterator(pos), true};
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    template <class... Args>
+    iterator emplace_hint(const_iterator, Args&&... args)
+    {
+        return emplace(std::forward<Args>(args)...).first;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& val)
+    {
+        return try_emplace(val.first, val.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& val)
+    {
+        return try_emplace(std::move(val.first), std::move(val.second));
+    }
+
+    template <class P,
+              class = typename std::enable_if<
+                  std::is_constructible<value_type, P&&>::value>::type>
+    std::pair<iterator, bool> insert(P&& val)
+    {
+        return insert(value_type(std::forward<P>(val)));
+    }
+
+    iterator insert(const_iterator, const value_type& val)
+    {
+        return insert(val).first;
+    }
+
+    iterator insert(const_iterator, value_type&& val)
+    {
+        return insert(std::move(val)).first;
+    }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        using category =
+            typename std::iterator_traits<InputIt>::iterator_category;
+        if (std::is_base_of<std::forward_iterator_tag, category>::value)
+            reserve(size() + std::distance(first, last));
+
+        for (; first != last; ++first)
+            try_emplace((*first).first, (*first).second);
+    }
+
+    void insert(std::initializer_list<value_type> il)
+    {
+        insert(il.begin(), il.end());
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        const size_type i = pos.key_ - keys().data();
+        key_container_type& k = own_keys();
+        k.erase(k.begin() + i);
+        values_.erase(values_.begin() + i);
+        return make_iterator(i);
+    }
+
+    iterator erase(iterator pos)
+    {
+        return erase(const_iterator(pos));
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const size_type i = first.key_ - keys().data();
+        const size_type j = last.key_ - keys().data();
+        if (i == j)
+            return make_iterator(i);
+
+        key_container_type& k = own_keys();
+        k.erase(k.begin() + i, k.begin() + j);
+        values_.erase(values_.begin() + i, values_.begin() + j);
+        return make_iterator(i);
+    }
+
+    size_type erase(const Key& key)
+    {
+        const auto i = find(key);
+        if (i == end())
+            return 0;
+
+        erase(i);
+        return 1;
+    }
+
+    void swap(Flat_Map& rhs) noexcept
+    {
+        using std::swap;
+        shape_.swap(rhs.shape_);
+        values_.swap(rhs.values_);
+        swap(comp_, rhs.comp_);
+    }
+
+    size_type count(const Key& key) const
+    {
+        return find(key) != end();
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        return find(key) != end();
+    }
+
+    bool contains(const Key& key) const
+    {
+        return find(key) != end();
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    bool contains(const K& key) const
+    {
+        return find(key) != end();
+    }
+
+    iterator find(const Key& key)
+    {
+        return make_iterator(find_index(key));
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        return make_iterator(find_index(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K& key)
+    {
+        return make_iterator(find_index(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        return make_iterator(find_index(key));
+    }
+
+    iterator lower_bound(const Key& key)
+    {
+        return make_iterator(lower_bound_index(key));
+    }
+
+    const_iterator lower_bound(const Key& key) const
+    {
+        return make_iterator(lower_bound_index(key));
+    }
+
+    iterator upper_bound(const Key& key)
+    {
+        return make_iterator(upper_bound_index(key));
+    }
+
+    const_iterator upper_bound(const Key& key) const
+    {
+        return make_iterator(upper_bound_index(key));
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& key)
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    key_compare key_comp() const
+    {
+        return comp_;
+    }
+
+    friend bool operator==(const Flat_Map& a, const Flat_Map& b)
+    {
+        return (a.shape_ == b.shape_ || a.keys() == b.keys()) &&
+               a.values_ == b.values_;
+    }
+
+    friend bool operator!=(const Flat_Map& a, const Flat_Map& b)
+    {
+        return !(a == b);
+    }
+
+    friend void swap(Flat_Map& a, Flat_Map& b) noexcept
+    {
+        a.swap(b);
+    }
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using shape_ptr = std::shared_ptr<key_container_type>;
+
+    static const key_container_type& empty_keys() noexcept
+    {
+        static const key_container_type keys;
+        return keys;
+    }
+
+    // polymorphic_allocator::construct() hands the allocator on to the
+    // vector, moving the keys in keeps that a pointer swap.
+    static shape_ptr make_shape(const Allocator& alloc, key_container_type&& keys)
+    {
+        return std::allocate_shared<key_container_type>(
+            rebind_alloc<key_container_type>(alloc), std::move(keys));
+    }
+
+    static shape_ptr copy_shape(const key_container_type& keys,
+                                const Allocator& alloc)
+    {
+        if (keys.empty())
+            return shape_ptr();
+
+        return make_shape(alloc,
+                          key_container_type(keys, rebind_alloc<Key>(alloc)));
+    }
+
+    // Key array to modify, copied first if another map refers to it.
+    key_container_type& own_keys()
+    {
+        const Allocator alloc = get_allocator();
+        if (!shape_)
+            shape_ = make_shape(alloc, key_container_type(rebind_alloc<Key>(alloc)));
+        else if (shape_.use_count() > 1)
+            shape_ = make_shape(alloc, key_container_type(*shape_, rebind_alloc<Key>(alloc)));
+
+        return *shape_;
+    }
+
+    iterator make_iterator(size_type pos)
+    {
+        return iterator(keys().data() + pos, values_.data() + pos);
+    }
+
+    const_iterator make_iterator(size_type pos) const
+    {
+        return const_iterator(keys().data() + pos, values_.data() + pos);
+    }
+
+    template <class K>
+    size_type lower_bound_index(const K& key) const
+    {
+        const key_container_type& k = keys();
+        return std::lower_bound(k.begin(), k.end(), key, comp_) - k.begin();
+    }
+
+    template <class K>
+    size_type upper_bound_index(const K& key) const
+    {
+        const key_container_type& k = keys();
+        return std::upper_bound(k.begin(), k.end(), key, comp_) - k.begin();
+    }
+
+    template <class K>
+    size_type find_index(const K& key) const
+    {
+        const size_type pos = lower_bound_index(key);
+        return pos < size() && !comp_(key, keys()[pos]) ? pos : size();
+    }
+
+    template <class K, class... Args>
+    void emplace_at(size_type pos, K&& key, Args&&... args)
+    {
+        key_container_type& k = own_keys();
+        k.emplace(k.begin() + pos, std::forward<K>(key));
+        try {
+            values_.emplace(values_.begin() + pos, std::forward<Args>(args)...);
+        } catch (...) {
+            k.erase(k.begin() + pos);
+            throw;
+        }
+    }
+
+    // Sorted keys, null while the map has never had a key.
+    shape_ptr shape_;
+    mapped_container_type values_;
+    Compare comp_;
+};
+
+} // namespace bjson
+
+#endif // BJSON_FLAT_MAP_H
@@ -0,0 +1,63 @@
+#include "huge_page_resource.h"
+
+#include <cassert>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif // __linux__
+
+namespace bjson {
+
+static size_t round_up(size_t bytes)
+{
+    return (bytes + Huge_Page_Resource::page_size - 1) &
+               ~(Huge_Page_Resource::page_size - 1);
+}
+
+void* Huge_Page_Resource::do_allocate(size_t bytes, size_t alignment)
+{
+#ifdef __linux__
+    // mmap returns page aligned memory, which is enough for any alignment
+    // an arena asks for.
+    assert(alignment <= page_size);
+    (void)alignment;
+
+    const size_t len = round_up(bytes);
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+        return p;
+
+    p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+
+    return p;
+#else // !__linux__
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+#endif // !__linux__
+}
+
+void Huge_Page_Resource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+#ifdef __linux__
+    (void)alignment;
+    munmap(p, round_up(bytes));
+#else // !__linux__
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+#endif // !__linux__
+}
+
+bool Huge_Page_Resource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+} // namespace bjson
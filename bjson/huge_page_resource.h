@@ -0,0 +1,33 @@
+/// \file huge_page_resource.h
+/// \brief Memory resource handing out whole (huge) pages from mmap.
+#ifndef BJSON_HUGE_PAGE_RESOURCE_H
+#define BJSON_HUGE_PAGE_RESOURCE_H
+
+#include "bjson_export.h"
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace bjson {
+
+/// \brief Upstream resource for arenas, e.g. the monotonic arena of Document.
+///
+/// Each allocation is rounded up to the huge page size and mapped with
+/// MAP_HUGETLB, if no huge page is reserved it falls back to a regular
+/// mapping advised with MADV_HUGEPAGE. Other platforms use operator new.
+class BJSON_EXPORT Huge_Page_Resource : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t page_size = 2 * 1024 * 1024;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+} // namespace bjson
+
+#endif // BJSON_HUGE_PAGE_RESOURCE_H
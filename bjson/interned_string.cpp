@@ -0,0 +1,162 @@
+#include "interned_string.h"
+
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bjson {
+
+namespace {
+
+// The table holds one reference on every entry, so a count of 1 means only
+// the table still knows the string, see Interned_String::purge().
+struct Pool
+{
+    std::mutex lock;
+    std::unordered_map<std::string_view, void*> table;
+};
+
+// Never destroyed, keys of static Values may be released after main().
+Pool& pool()
+{
+    static Pool* p = new Pool;
+    return *p;
+}
+
+} // namespace
+
+Interned_String::Rep* Interned_String::make_rep(std::string_view str, uint32_t refs)
+{
+    if (str.size() > std::numeric_limits<uint32_t>::max())
+        throw std::length_error("Interned_String: string is too long");
+
+    void* p = ::operator new(offsetof(Rep, data) + str.size() + 1);
+    Rep* rep = static_cast<Rep*>(p);
+    ::new (&rep->refs) std::atomic<uint32_t>(refs);
+    rep->size = static_cast<uint32_t>(str.size());
+    rep->hash = hash_key(str);
+    std::memcpy(rep->data, str.data(), str.size());
+    rep->data[str.size()] = '\0';
+    return rep;
+}
+
+Interned_String::Interned_String(Rep* rep) noexcept : rep_(rep)
+{
+}
+
+Interned_String::Interned_String(std::string_view str)
+    : rep_(str.empty() ? nullptr : make_rep(str, 1))
+{
+}
+
+Interned_String::Interned_String(const std::string& str)
+    : Interned_String(std::string_view(str))
+{
+}
+
+Interned_String::Interned_String(const char* str)
+    : Interned_String(std::string_view(str))
+{
+}
+
+Interned_String& Interned_String::operator=(const Interned_String& rhs) noexcept
+{
+    if (rhs.rep_)
+        rhs.rep_->refs.fetch_add(1, std::memory_order_relaxed);
+    release();
+    rep_ = rhs.rep_;
+    return *this;
+}
+
+Interned_String& Interned_String::operator=(Interned_String&& rhs) noexcept
+{
+    if (this != &rhs) {
+        release();
+        rep_ = rhs.rep_;
+        rhs.rep_ = nullptr;
+    }
+
+    return *this;
+}
+
+void Interned_String::release() noexcept
+{
+    if (rep_ && rep_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        rep_->refs.~atomic();
+        ::operator delete(rep_);
+    }
+
+    rep_ = nullptr;
+}
+
+Interned_String Interned_String::intern(std::string_view str)
+{
+    if (str.empty())
+        return Interned_String();
+
+    Pool& p = pool();
+    std::lock_guard<std::mutex> guard(p.lock);
+
+    auto it = p.table.find(str);
+    if (it != p.table.end()) {
+        Rep* rep = static_cast<Rep*>(it->second);
+        rep->refs.fetch_add(1, std::memory_order_relaxed);
+        return Interned_String(rep);
+    }
+
+    Rep* rep = make_rep(str, 2);
+    try {
+        p.table.emplace(std::string_view(rep->data, rep->size), rep);
+    } catch (...) {
+        ::operator delete(rep);
+        throw;
+    }
+
+    return Interned_String(rep);
+}
+
+size_t Interned_String::purge()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> guard(p.lock);
+
+    // A handle is needed to copy a handle, and intern() runs under the lock,
+    // so nobody can take a reference while the count is 1.
+    size_t released = 0;
+    for (auto it = p.table.begin(); it != p.table.end();) {
+        Rep* rep = static_cast<Rep*>(it->second);
+        uint32_t expected = 1;
+        if (rep->refs.compare_exchange_strong(expected, 0,
+                                              std::memory_order_acq_rel)) {
+            it = p.table.erase(it);
+            rep->refs.~atomic();
+            ::operator delete(rep);
+            ++released;
+        } else {
+            ++it;
+        }
+    }
+
+    return released;
+}
+
+size_t Interned_String::pool_size()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> guard(p.lock);
+    return p.table.size();
+}
+
+std::string Interned_String::str() const
+{
+    return std::string(c_str(), size());
+}
+
+Interned_String::operator std::string() const
+{
+    return str();
+}
+
+} // namespace bjson
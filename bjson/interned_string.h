@@ -0,0 +1,225 @@
+/// \file interned_string.h
+/// \brief Immutable reference counted string, optionally shared through a
+///        global interning table.
+#ifndef BJSON_INTERNED_STRING_H
+#define BJSON_INTERNED_STRING_H
+
+#include "bjson_export.h"
+#include "key.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace bjson {
+
+/// \brief Key type of Object when built with BJSON_INTERNED_KEYS.
+///
+/// Copies share one immutable buffer. Handles returned by intern() for the
+/// same text share the buffer of the global table, so records repeating
+/// "id", "name", ... keep a single copy of each key, and comparing two
+/// interned keys is a pointer comparison.
+///
+/// It converts to std::string_view and std::string, and provides the
+/// read only members of std::string used on Object keys.
+class BJSON_EXPORT Interned_String
+{
+public:
+    Interned_String() = default;
+
+    /// Private copy of the text, it is not entered into the table.
+    Interned_String(std::string_view str);
+    Interned_String(const std::string& str);
+    Interned_String(const char* str);
+
+    Interned_String(const Interned_String& rhs) noexcept;
+    Interned_String(Interned_String&& rhs) noexcept;
+
+    Interned_String& operator=(const Interned_String& rhs) noexcept;
+    Interned_String& operator=(Interned_String&& rhs) noexcept;
+
+    ~Interned_String();
+
+    /// \brief Shared handle of \a str from the global table.
+    static Interned_String intern(std::string_view str);
+
+    /// \brief Drop table entries no handle refers to any more.
+    /// \return Number of entries released.
+    static size_t purge();
+
+    /// \brief Number of entries in the global table.
+    static size_t pool_size();
+
+    const char* c_str() const noexcept;
+    const char* data() const noexcept;
+    size_t size() const noexcept;
+    size_t length() const noexcept;
+    bool empty() const noexcept;
+    size_t hash() const noexcept;
+
+    std::string str() const;
+
+    operator std::string_view() const noexcept;
+    operator std::string() const;
+
+    friend bool operator==(const Interned_String& a, const Interned_String& b) noexcept
+    {
+        return a.rep_ == b.rep_ || std::string_view(a) == std::string_view(b);
+    }
+
+    friend bool operator<(const Interned_String& a, const Interned_String& b) noexcept
+    {
+        return a.rep_ != b.rep_ && std::string_view(a) < std::string_view(b);
+    }
+
+private:
+    struct Rep
+    {
+        std::atomic<uint32_t> refs;
+        uint32_t size;
+        size_t hash;
+        char data[1];
+    };
+
+    static Rep* make_rep(std::string_view str, uint32_t refs);
+
+    explicit Interned_String(Rep* rep) noexcept;
+
+    void release() noexcept;
+
+    Rep* rep_ = nullptr;
+};
+
+inline Interned_String::Interned_String(const Interned_String& rhs) noexcept
+    : rep_(rhs.rep_)
+{
+    if (rep_)
+        rep_->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline Interned_String::Interned_String(Interned_String&& rhs) noexcept
+    : rep_(rhs.rep_)
+{
+    rhs.rep_ = nullptr;
+}
+
+inline Interned_String::~Interned_String()
+{
+    release();
+}
+
+inline const char* Interned_String::c_str() const noexcept
+{
+    return rep_ ? rep_->data : "";
+}
+
+inline const char* Interned_String::data() const noexcept
+{
+    return c_str();
+}
+
+inline size_t Interned_String::size() const noexcept
+{
+    return rep_ ? rep_->size : 0;
+}
+
+inline size_t Interned_String::length() const noexcept
+{
+    return size();
+}
+
+inline bool Interned_String::empty() const noexcept
+{
+    return !rep_ || rep_->size == 0;
+}
+
+inline size_t Interned_String::hash() const noexcept
+{
+    return rep_ ? rep_->hash : hash_key(std::string_view());
+}
+
+inline Interned_String::operator std::string_view() const noexcept
+{
+    return std::string_view(c_str(), size());
+}
+
+// Mixed comparisons go through string_view, so a transparent comparator
+// finds a key from std::string or const char* without building a key.
+#define BJSON_INTERNED_STRING_COMPARE(TYPE) \
+inline bool operator==(const Interned_String& a, TYPE b) \
+{ \
+    return std::string_view(a) == std::string_view(b); \
+} \
+\
+inline bool operator==(TYPE a, const Interned_String& b) \
+{ \
+    return std::string_view(a) == std::string_view(b); \
+} \
+\
+inline bool operator!=(const Interned_String& a, TYPE b) \
+{ \
+    return !(a == b); \
+} \
+\
+inline bool operator!=(TYPE a, const Interned_String& b) \
+{ \
+    return !(a == b); \
+} \
+\
+inline bool operator<(const Interned_String& a, TYPE b) \
+{ \
+    return std::string_view(a) < std::string_view(b); \
+} \
+\
+inline bool operator<(TYPE a, const Interned_String& b) \
+{ \
+    return std::string_view(a) < std::string_view(b); \
+}
+
+BJSON_INTERNED_STRING_COMPARE(const std::string&)
+BJSON_INTERNED_STRING_COMPARE(std::string_view)
+BJSON_INTERNED_STRING_COMPARE(const char*)
+
+#undef BJSON_INTERNED_STRING_COMPARE
+
+inline bool operator!=(const Interned_String& a, const Interned_String& b)
+{
+    return !(a == b);
+}
+
+inline std::string operator+(const std::string& a, const Interned_String& b)
+{
+    return a + std::string(b);
+}
+
+inline std::string operator+(const Interned_String& a, const std::string& b)
+{
+    return std::string(a) + b;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Interned_String& str)
+{
+    return os << std::string_view(str);
+}
+
+} // namespace bjson
+
+namespace std {
+
+template <>
+struct hash<bjson::Interned_String>
+{
+    size_t operator()(const bjson::Interned_String& str) const noexcept
+    {
+        return str.hash();
+    }
+};
+
+} // namespace std
+
+#endif // BJSON_INTERNED_STRING_H
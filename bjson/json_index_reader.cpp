@@ -0,0 +1,487 @@
+#include "json_index_reader.h"
+#include "json_reader.h"
+#include "structural_index.h"
+
+#include <ace/Log_Msg.h>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Bytes of numbers and literals, anything else ends them.
+inline bool is_scalar_byte(char c)
+{
+    switch (c) {
+    case '{': case '}': case '[': case ']': case ':': case ',': case '"':
+    case ' ': case '\t': case '\n': case '\r':
+        return false;
+    default:
+        return true;
+    }
+}
+
+inline int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    c |= 0x20;
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+bool read_hex4(const char* p, const char* end, unsigned& val)
+{
+    if (end - p < 4)
+        return false;
+
+    val = 0;
+    for (int i = 0; i < 4; ++i) {
+        const int d = hex_digit(p[i]);
+        if (d < 0)
+            return false;
+
+        val = (val << 4) | d;
+    }
+
+    return true;
+}
+
+// Length of the UTF-8 sequence at p, 0 if it is not one. It checks what
+// yajl checks, the lead byte and the number of continuation bytes.
+size_t utf8_length(const char* p, const char* end)
+{
+    const unsigned char c = *p;
+    size_t n;
+    if ((c >> 5) == 0x6)
+        n = 2;
+    else if ((c >> 4) == 0xe)
+        n = 3;
+    else if ((c >> 3) == 0x1e)
+        n = 4;
+    else
+        return 0;
+
+    if (static_cast<size_t>(end - p) < n)
+        return 0;
+
+    for (size_t i = 1; i < n; ++i)
+        if ((static_cast<unsigned char>(p[i]) >> 6) != 0x2)
+            return 0;
+
+    return n;
+}
+
+void append_utf8(string& out, unsigned cp)
+{
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xc0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xe0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x200000) {
+        out += static_cast<char>(0xf0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else {
+        out += '?';
+    }
+}
+
+const char* const cancelled = "client cancelled parse via callback return value";
+
+} // namespace
+
+DEFAULT_CTOR_DTOR_DEFINES(JSON_Index_Reader)
+
+bool JSON_Index_Reader::read(const char* buf, size_t len, int flags)
+{
+    error_ = nullptr;
+    error_offset_ = 0;
+    buf_ = buf;
+
+    bool ok;
+    if (len >= numeric_limits<uint32_t>::max())
+        ok = fail("text too large for the structural index", buf);
+    else if (!bjson::structural_index(buf, len, index_))
+        ok = fail("premature EOF, a string is not closed", buf + len);
+    else
+        ok = parse(buf, len, index_.data(), index_.data() + index_.size());
+
+    if (!ok && (flags & JSON_Reader::FG_LOGGING))
+        ACE_ERROR((LM_ERROR,
+                   ACE_TEXT("Failed to parse JSON: %s, at offset %u\n"),
+                   error_,
+                   static_cast<unsigned>(error_offset_)));
+
+    return ok;
+}
+
+bool JSON_Index_Reader::read(const char* buf,
+                             size_t len,
+                             const uint32_t* first,
+                             const uint32_t* last,
+                             int flags)
+{
+    error_ = nullptr;
+    error_offset_ = 0;
+    buf_ = buf;
+
+    const bool ok = parse(buf, len, first, last);
+    if (!ok && (flags & JSON_Reader::FG_LOGGING))
+        ACE_ERROR((LM_ERROR,
+                   ACE_TEXT("Failed to parse JSON: %s, at offset %u\n"),
+                   error_,
+                   static_cast<unsigned>(error_offset_)));
+
+    return ok;
+}
+
+const char* JSON_Index_Reader::error() const
+{
+    return error_;
+}
+
+size_t JSON_Index_Reader::error_offset() const
+{
+    return error_offset_;
+}
+
+bool JSON_Index_Reader::fail(const char* error, const char* p)
+{
+    error_ = error;
+    error_offset_ = p - buf_;
+    return false;
+}
+
+bool JSON_Index_Reader::parse(const char* buf,
+                              size_t len,
+                              const uint32_t* first,
+                              const uint32_t* last)
+{
+    const char* const end = buf + len;
+    const uint32_t* i = first;
+    containers_.clear();
+
+    // Key of a member and the colon after it, the key is token i.
+    const auto member_key = [&]() -> bool {
+        if (i == last)
+            return fail("premature EOF", end);
+
+        const char* p = buf + *i++;
+        if (*p != '"')
+            return fail("invalid object key (must be a string)", p);
+
+        if (!parse_string(p, end, true))
+            return false;
+
+        if (i == last)
+            return fail("premature EOF", end);
+
+        p = buf + *i++;
+        return *p == ':' ||
+               fail("object key and value must be separated by a colon (':')", p);
+    };
+
+    for (;;) {
+        if (i == last)
+            return fail("premature EOF", end);
+
+        // A value starts at the token.
+        const char* p = buf + *i++;
+        const bool container = *p == '{' || *p == '[';
+        if (projection_ && skip_value(container)) {
+            if (container && !skip_container(buf, end, i, last))
+                return false;
+        } else {
+            switch (*p) {
+            case '{':
+                if (!handle_start_map_i())
+                    return fail(cancelled, p);
+
+                if (i != last && buf[*i] == '}') {
+                    ++i;
+                    if (!handle_end_map_i())
+                        return fail(cancelled, p);
+
+                    break;
+                }
+
+                containers_.push_back('{');
+                if (!member_key())
+                    return false;
+
+                continue;
+            case '[':
+                if (!handle_start_array_i())
+                    return fail(cancelled, p);
+
+                if (i != last && buf[*i] == ']') {
+                    ++i;
+                    if (!handle_end_array_i())
+                        return fail(cancelled, p);
+
+                    break;
+                }
+
+                containers_.push_back('[');
+                continue;
+            case '"':
+                if (!parse_string(p, end, false))
+                    return false;
+
+                break;
+            case 't':
+            case 'f':
+            case 'n':
+                if (!parse_literal(p, end))
+                    return false;
+
+                break;
+            default:
+                if (*p != '-' && !is_digit(*p))
+                    return fail("invalid char in json text", p);
+
+                if (!parse_number(p, end))
+                    return false;
+
+                break;
+            }
+        }
+
+        // The value is complete, close the containers it completes.
+        for (;;) {
+            if (containers_.empty())
+                return i == last || fail("trailing garbage", buf + *i);
+
+            if (i == last)
+                return fail("premature EOF", end);
+
+            p = buf + *i++;
+            if (containers_.back() == '{') {
+                if (*p == ',') {
+                    if (!member_key())
+                        return false;
+
+                    break;
+                }
+
+                if (*p != '}')
+                    return fail("after key and value, inside map, "
+                                "I expect ',' or '}'", p);
+
+                containers_.pop_back();
+                if (!handle_end_map_i())
+                    return fail(cancelled, p);
+            } else {
+                if (*p == ',')
+                    break;
+
+                if (*p != ']')
+                    return fail("after array element, I expect ',' or ']'", p);
+
+                containers_.pop_back();
+                if (!handle_end_array_i())
+                    return fail(cancelled, p);
+            }
+        }
+    }
+}
+
+// The opening bracket of the container is token i - 1. Only the brackets
+// are matched, nothing in between is looked at.
+bool JSON_Index_Reader::skip_container(const char* buf,
+                                       const char* end,
+                                       const uint32_t*& i,
+                                       const uint32_t* last)
+{
+    const size_t open = containers_.size();
+    containers_.push_back(buf[i[-1]]);
+    while (containers_.size() != open) {
+        if (i == last)
+            return fail("premature EOF", end);
+
+        const char* p = buf + *i++;
+        switch (*p) {
+        case '{':
+        case '[':
+            containers_.push_back(*p);
+            break;
+        case '}':
+        case ']':
+            if (containers_.back() != (*p == '}' ? '{' : '['))
+                return fail("unbalanced brackets in a skipped value", p);
+
+            containers_.pop_back();
+            break;
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool JSON_Index_Reader::parse_string(const char* p, const char* end, bool key)
+{
+    const char* const begin = ++p;
+    while (p != end && *p != '"' && *p != '\\' &&
+           static_cast<unsigned char>(*p) >= 0x20 &&
+           static_cast<unsigned char>(*p) < 0x80)
+        ++p;
+
+    const char* text = begin;
+    size_t size = p - begin;
+
+    // Strings of plain ASCII are handed over from the text itself.
+    if (p == end || *p != '"') {
+        text_.assign(begin, p);
+        for (;;) {
+            const char* run = p;
+            while (p != end && *p != '"' && *p != '\\' &&
+                   static_cast<unsigned char>(*p) >= 0x20 &&
+                   static_cast<unsigned char>(*p) < 0x80)
+                ++p;
+
+            text_.append(run, p);
+            if (p == end)
+                return fail("premature EOF", p);
+
+            const unsigned char c = *p;
+            if (c == '"')
+                break;
+
+            if (c < 0x20)
+                return fail("invalid character inside string", p);
+
+            if (c >= 0x80) {
+                const size_t n = utf8_length(p, end);
+                if (!n)
+                    return fail("invalid bytes in UTF8 string", p);
+
+                text_.append(p, n);
+                p += n;
+                continue;
+            }
+
+            if (end - p < 2)
+                return fail("premature EOF", p);
+
+            unsigned cp;
+            switch (p[1]) {
+            case '"': text_ += '"'; break;
+            case '\\': text_ += '\\'; break;
+            case '/': text_ += '/'; break;
+            case 'b': text_ += '\b'; break;
+            case 'f': text_ += '\f'; break;
+            case 'n': text_ += '\n'; break;
+            case 'r': text_ += '\r'; break;
+            case 't': text_ += '\t'; break;
+            case 'u':
+                if (!read_hex4(p + 2, end, cp))
+                    return fail("invalid (non-hex) character occurs after "
+                                "'\\u' inside string", p);
+
+                p += 4;
+
+                // Combined as yajl does, a high surrogate without a second
+                // escape becomes '?'.
+                if ((cp & 0xfc00) == 0xd800) {
+                    unsigned low;
+                    if (end - p >= 8 && p[2] == '\\' && p[3] == 'u' &&
+                        read_hex4(p + 4, end, low)) {
+                        cp = ((cp & 0x3f) << 10) |
+                             ((((cp >> 6) & 0xf) + 1) << 16) |
+                             (low & 0x3ff);
+                        p += 6;
+                    } else {
+                        cp = '?';
+                    }
+                }
+
+                append_utf8(text_, cp);
+                break;
+            default:
+                return fail("inside a JSON string, an invalid escape "
+                            "was encountered", p);
+            }
+
+            p += 2;
+        }
+
+        text = text_.data();
+        size = text_.size();
+    }
+
+    const bool ok = key ? handle_map_key_i(text, size)
+                        : handle_string_i(text, size);
+    return ok || fail(cancelled, begin - 1);
+}
+
+bool JSON_Index_Reader::parse_number(const char* p, const char* end)
+{
+    const char* const begin = p;
+    if (*p == '-')
+        ++p;
+
+    if (p == end || !is_digit(*p))
+        return fail("malformed number, a digit is required after "
+                    "the minus sign", p);
+
+    if (*p++ != '0')
+        while (p != end && is_digit(*p))
+            ++p;
+
+    if (p != end && *p == '.') {
+        if (++p == end || !is_digit(*p))
+            return fail("malformed number, a digit is required after "
+                        "the decimal point", p);
+
+        while (p != end && is_digit(*p))
+            ++p;
+    }
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        if (++p != end && (*p == '+' || *p == '-'))
+            ++p;
+
+        if (p == end || !is_digit(*p))
+            return fail("malformed number, a digit is required after "
+                        "the exponent", p);
+
+        while (p != end && is_digit(*p))
+            ++p;
+    }
+
+    if (p != end && is_scalar_byte(*p))
+        return fail("invalid char in json text", p);
+
+    return handle_number_i(begin, p - begin) || fail(cancelled, begin);
+}
+
+bool JSON_Index_Reader::parse_literal(const char* p, const char* end)
+{
+    static const char* const literals[] = {"true", "false", "null"};
+
+    const char* literal = literals[*p == 't' ? 0 : *p == 'f' ? 1 : 2];
+    const size_t n = strlen(literal);
+    if (static_cast<size_t>(end - p) < n || memcmp(p, literal, n) != 0 ||
+        (p + n != end && is_scalar_byte(p[n])))
+        return fail("invalid string in json text", p);
+
+    const bool ok = *p == 'n' ? handle_null_i() : handle_boolean_i(*p == 't');
+    return ok || fail(cancelled, p);
+}
+
+// vim: set ts=4 sw=4 sts=4 et:
@@ -0,0 +1,87 @@
+/*!
+ * \file json_index_reader.h
+ * \brief It parses a whole JSON text from its structural index.
+ */
+
+#ifndef JSON_INDEX_READER_H
+#define JSON_INDEX_READER_H
+
+#include "json_parser.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// \brief Alternative to JSON_Reader for texts held in memory at once.
+///
+/// bjson::structural_index() first finds every token with SIMD compares,
+/// then the tokens are walked in order and handed to the JSON_Parser
+/// handlers, so the result is the Value JSON_Reader builds. The accepted
+/// grammar is the one of yajl with its default options: a single value
+/// of any type, no comments, strings checked for UTF-8.
+///
+/// Values off a projection, see JSON_Parser::projection(), are passed over
+/// token by token without looking at their bytes. Only their brackets are
+/// matched, a malformed scalar or separator inside them is not reported.
+///
+/// loads_json() and load_json() use it with JSON_Reader::FG_STRUCTURAL_INDEX.
+class JSON_SPIRIT_Export JSON_Index_Reader: public JSON_Parser
+{
+public:
+    DEFAULT_CTOR_DTOR_DECLARES(JSON_Index_Reader);
+
+    /// \brief Parse the complete text \a buf into the result.
+    /// \param flags JSON_Reader::FG_LOGGING logs the reason of a failure.
+    bool read(const char* buf, size_t len, int flags);
+
+    /// \brief Parse the value made of the tokens [\a first, \a last) of
+    ///        the structural index of \a buf, without indexing it again.
+    ///
+    /// The tokens must be a whole value, e.g. a subtree of a text indexed
+    /// once, error_offset() is then an offset in \a buf.
+    bool read(const char* buf,
+              size_t len,
+              const uint32_t* first,
+              const uint32_t* last,
+              int flags);
+
+    /// \brief Reason of the last failure of read().
+    const char* error() const;
+
+    /// \brief Offset in the text where the last failure of read() was found.
+    size_t error_offset() const;
+
+private:
+    bool parse(const char* buf,
+               size_t len,
+               const uint32_t* first,
+               const uint32_t* last);
+
+    // Passes over the tokens of a container off the projection.
+    bool skip_container(const char* buf,
+                        const char* end,
+                        const uint32_t*& i,
+                        const uint32_t* last);
+
+    // p is the first byte of the value, it is handed to the handlers.
+    bool parse_string(const char* p, const char* end, bool key);
+    bool parse_number(const char* p, const char* end);
+    bool parse_literal(const char* p, const char* end);
+
+    bool fail(const char* error, const char* p);
+
+    std::vector<uint32_t> index_;
+
+    // Open containers, '{' or '['.
+    std::vector<char> containers_;
+
+    // Strings with escapes are decoded into it.
+    std::string text_;
+
+    const char* buf_ = nullptr;
+    const char* error_ = nullptr;
+    size_t error_offset_ = 0;
+};
+
+#endif /* JSON_INDEX_READER_H */
+// vim: set ts=4 sw=4 sts=4 et:
@@ -0,0 +1,209 @@
+#include "json_lines_reader.h"
+#include "text_util.h"
+
+#include "scrt/yajl_error.h"
+#include <ace/Log_Msg.h>
+#include <cstring>
+#include <yajl/yajl_parse.h>
+
+using json_spirit::Value;
+
+namespace {
+
+using bjson::detail::is_space;
+
+// Start of the line of buf an error at offset error was found on, if the
+// record failing there began on an earlier line, null otherwise. The
+// records parsed from buf end at offset settled, began_before tells that
+// the record was open when buf came, line_start that buf starts a line.
+const char* error_line(const char* buf,
+                       size_t settled,
+                       size_t error,
+                       bool began_before,
+                       bool line_start)
+{
+    const char* const from = buf + settled;
+    const char* line = buf + error;
+    while (line != from && line[-1] != '\n')
+        --line;
+
+    if (line == from && !(line == buf && line_start))
+        return nullptr;
+
+    if (!settled && began_before)
+        return line;
+
+    for (const char* p = from; p != line; ++p)
+        if (!is_space(*p))
+            return line;
+
+    return nullptr;
+}
+
+} // namespace
+
+JSON_Lines_Reader::JSON_Lines_Reader(Callback callback)
+    : callback_(std::move(callback))
+{
+    result(&record_);
+}
+
+JSON_Lines_Reader::~JSON_Lines_Reader() = default;
+
+bool JSON_Lines_Reader::open()
+{
+    // A partial record of the previous stream is dropped.
+    frames_.clear();
+    values_.clear();
+    keys_.clear();
+    record_ = Value();
+    skipping_ = false;
+    stopped_ = false;
+    line_start_ = true;
+
+    if (!JSON_Reader::open())
+        return false;
+
+    yajl_config(handle_.get(), yajl_allow_multiple_values, 1);
+    return true;
+}
+
+bool JSON_Lines_Reader::read(const char* buf, size_t len, int flags)
+{
+    if (!handle_ || stopped_)
+        return false;
+
+    bool line_start = line_start_;
+    if (buf) {
+        const char* end = buf + len;
+        while (end != buf && end[-1] != '\n' && is_space(end[-1]))
+            --end;
+
+        if (end != buf)
+            line_start_ = end[-1] == '\n';
+    }
+
+    for (;;) {
+        if (skipping_) {
+            if (!buf)
+                return true;
+
+            const char* eol = static_cast<const char*>(memchr(buf, '\n', len));
+            if (!eol)
+                return true;
+
+            skipping_ = false;
+            line_start = true;
+            len -= eol + 1 - buf;
+            buf = eol + 1;
+        }
+
+        const bool began_before = levels() != 0;
+        settled_ = 0;
+        const yajl_status status =
+            buf ? yajl_parse(handle_.get(), (const unsigned char*)buf, len)
+                : yajl_complete_parse(handle_.get());
+        if (status == yajl_status_ok)
+            return true;
+
+        if (stopped_)
+            return false;
+
+        if (flags & FG_LOGGING)
+            ACE_ERROR((LM_ERROR,
+                       ACE_TEXT("Failed to parse JSON record %u: %s\n"),
+                       static_cast<unsigned>(records_ + invalid_ + 1),
+                       YAJL_Error(handle_.get(), true,
+                                 (const u_char*)buf, len).c_str()));
+
+        if (!skip_invalid_)
+            return false;
+
+        // yajl does not recover from an error, the handle starts over. A
+        // record cut short, e.g. by a truncated write, is only found bad on
+        // the line after it, which may hold a whole record: parsing starts
+        // over at the start of that line. Otherwise it starts over after
+        // the line of the record.
+        ++invalid_;
+        const size_t consumed = buf ? yajl_get_bytes_consumed(handle_.get()) : len;
+        const char* const line =
+            buf ? error_line(buf, settled_, consumed, began_before, line_start)
+                : nullptr;
+        if (!open())
+            return false;
+
+        if (!buf)
+            return true;
+
+        line_start = true;
+        if (line) {
+            len -= line - buf;
+            buf = line;
+            continue;
+        }
+
+        buf += consumed;
+        len -= consumed;
+        skipping_ = true;
+    }
+}
+
+void JSON_Lines_Reader::skip_invalid(bool on)
+{
+    skip_invalid_ = on;
+}
+
+size_t JSON_Lines_Reader::records() const
+{
+    return records_;
+}
+
+size_t JSON_Lines_Reader::invalid() const
+{
+    return invalid_;
+}
+
+bool JSON_Lines_Reader::handle_null_i()
+{
+    return JSON_Reader::handle_null_i() && (levels() || record());
+}
+
+bool JSON_Lines_Reader::handle_boolean_i(bool val)
+{
+    return JSON_Reader::handle_boolean_i(val) && (levels() || record());
+}
+
+bool JSON_Lines_Reader::handle_number_i(const char* val, size_t len)
+{
+    return JSON_Reader::handle_number_i(val, len) && (levels() || record());
+}
+
+bool JSON_Lines_Reader::handle_string_i(const char* val, size_t len)
+{
+    return JSON_Reader::handle_string_i(val, len) && (levels() || record());
+}
+
+bool JSON_Lines_Reader::handle_end_map_i()
+{
+    return JSON_Reader::handle_end_map_i() && (levels() || record());
+}
+
+bool JSON_Lines_Reader::handle_end_array_i()
+{
+    return JSON_Reader::handle_end_array_i() && (levels() || record());
+}
+
+bool JSON_Lines_Reader::record()
+{
+    ++records_;
+    settled_ = yajl_get_bytes_consumed(handle_.get());
+    if (!callback_(record_)) {
+        stopped_ = true;
+        return false;
+    }
+
+    record_ = Value();
+    return true;
+}
+
+// vim: set ts=4 sw=4 sts=4 et:
@@ -0,0 +1,95 @@
+/*!
+ * \file json_lines_reader.h
+ * \brief It parses a stream of JSON records, one per line (NDJSON).
+ */
+
+#ifndef JSON_LINES_READER_H
+#define JSON_LINES_READER_H
+
+#include "json_reader.h"
+
+#include <functional>
+
+/// \brief JSON_Reader for streams of top level values, e.g. JSON Lines.
+///
+/// Chunks are given to read() as they come, cut anywhere, and the callback
+/// gets each record once its value is complete:
+///
+///     JSON_Lines_Reader reader([&](json_spirit::Value& record) {
+///         ingest(std::move(record));
+///         return true;
+///     });
+///     if (!reader.open())
+///         ...
+///     while ((n = next_chunk(buf, sizeof(buf))) > 0)
+///         if (!reader.read(buf, n))
+///             ...
+///     reader.read(nullptr, 0);
+///
+/// One yajl handle parses the whole stream and records are built in the
+/// same scratch Value, nothing is allocated per record besides the record
+/// itself. Records are separated by any whitespace, so a record may also
+/// span lines.
+class JSON_SPIRIT_Export JSON_Lines_Reader: public JSON_Reader
+{
+public:
+    /// \brief Called with each record, it may move from it. Returning
+    ///        false stops the stream, read() fails from then on.
+    using Callback = std::function<bool(json_spirit::Value& record)>;
+
+    explicit JSON_Lines_Reader(Callback callback);
+    virtual ~JSON_Lines_Reader();
+
+    /// \brief Start a new stream.
+    virtual bool open();
+
+    /// \brief Parse the next chunk of the stream, \a buf null ends it.
+    virtual bool read(const char* buf, size_t len, int flags = FG_LOGGING);
+
+    /// \brief Skip the rest of the line of a malformed record instead of
+    ///        failing the stream, the record is counted by invalid().
+    ///
+    /// A record found bad on a later line than it began on, e.g. one cut
+    /// short before its newline, is dropped up to the start of that line
+    /// only, so the record there is still parsed. That line has to start
+    /// in the chunk of the error, or right after the previous chunk.
+    void skip_invalid(bool on);
+
+    /// \brief Records handed to the callback since construction.
+    size_t records() const;
+
+    /// \brief Malformed records skipped since construction.
+    size_t invalid() const;
+
+    virtual bool handle_null_i();
+    virtual bool handle_boolean_i(bool val);
+    virtual bool handle_number_i(const char* val, size_t len);
+    virtual bool handle_string_i(const char* val, size_t len);
+    virtual bool handle_end_map_i();
+    virtual bool handle_end_array_i();
+
+private:
+    // A top level value is complete.
+    bool record();
+
+    Callback callback_;
+    json_spirit::Value record_;
+    size_t records_ = 0;
+    size_t invalid_ = 0;
+    bool skip_invalid_ = false;
+
+    // Input is dropped up to the next newline.
+    bool skipping_ = false;
+
+    // Only whitespace came since the last newline.
+    bool line_start_ = true;
+
+    // Bytes of the chunk being parsed up to the end of its last record.
+    size_t settled_ = 0;
+
+    // The callback stopped the stream.
+    bool stopped_ = false;
+};
+
+#endif /* JSON_LINES_READER_H */
+// vim: set ts=4 sw=4 sts=4 et:
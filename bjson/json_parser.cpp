@@ -1,151 +1,296 @@
 #include "json_parser.h"
 #include "number_to_value.h"
+#include "projection.h"
 #include "ace/Log_Msg.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace json_spirit;
 
-template <class T>
-bool prepare_structured_value (stack<Value*>& current, const string& key)
-{
-	if (current.empty ())
-		ACE_ERROR_RETURN ((LM_DEBUG,
-			"prepare_structured_value: current stack is empty, return false!"),
-			false);
-
-	Value*& top = current.top ();
-	switch (top->type ()) {
-		case obj_type:
-			{
-				Object& obj = top->get_obj ();
-				obj[key] =  T ();
-				current.push (&obj[key]);
-			}
-			break;
-		case array_type:
-			{
-				Array& arr = top->get_array ();
-				arr.push_back (T ());
-				current.push (&arr.back ());
-			}
-			break;
-		default:
-			if (current.size () == 1) {
-				*top = T ();
-			} else {
-				ACE_ASSERT (false);
-				ACE_ERROR_RETURN ((LM_ERROR,
-					"prepare_structured_value: the top item of current stack is neither object nor array, return false!\n"),
-					false);
-			}
-	}
-
-	return true;
-}
-
-template <class T>
-bool set_value (stack<Value*>& current, const string& key, const T& value)
-{
-	if (current.empty ())
-		ACE_ERROR_RETURN ((LM_DEBUG,
-			"set_value: current stack is empty!\n"),
-			false);
-
-	Value*& top = current.top ();
-	if (!key.empty ()) {
-		switch (top->type ()) {
-			case obj_type:
-				top->get_obj ()[key] = value;
-				break;
-			case array_type:
-				top->get_array ().push_back (value);
-				break;
-			default:
-				ACE_ERROR_RETURN ((LM_ERROR,
-					"set_value: the top item(type=%d) of current stack must be object nor array!\n",
-					top->type ()),
-					false);
-		}
-	} else if (top->type () == array_type) {
-		top->get_array ().push_back (value);
-	} else {
-		*top =  value;
-	}
-
-	return true;
-}
-
 DEFAULT_CTOR_DTOR_DEFINES(JSON_Parser)
 
 bool JSON_Parser::handle_null_i ()
 {
-	return set_value <Value> (current_, key_, Value::null);
+	if (projection_ && (skipped_ || !keep (false)))
+		return true;
+
+	add (Value ());
+	return true;
 }
 
 bool JSON_Parser::handle_boolean_i (bool val)
 {
-	return set_value <Value> (current_, key_, Value (val));
+	if (projection_ && (skipped_ || !keep (false)))
+		return true;
+
+	add (Value (val));
+	return true;
 }
 
 bool JSON_Parser::handle_number_i (const char* val, size_t len)
 {
+	if (projection_ && (skipped_ || !keep (false)))
+		return true;
+
 	Value v;
 	number_to_value (val, len, v);
-	return set_value <Value> (current_, key_, v);
+	add (std::move (v));
+	return true;
 }
 
 bool JSON_Parser::handle_string_i (const char* val, size_t len)
 {
-	return set_value <Value> (current_, key_, Value (string (val, len)));
+	if (projection_ && (skipped_ || !keep (false)))
+		return true;
+
+	add (Value (string_view (val, len), resource_));
+	return true;
 }
 
 bool JSON_Parser::handle_start_map_i ()
 {
-	return prepare_structured_value<Object> (current_, key_);
+	if (projection_ && (skipped_ || !keep (true))) {
+		++skipped_;
+		return true;
+	}
+
+	frames_.push_back (Frame {values_.size (), keys_.size (), true, node_, 0});
+	return true;
 }
 
 bool JSON_Parser::handle_map_key_i (const char* key, size_t len)
 {
+	if (skipped_)
+		return true;
+
 	key_.assign (key, len);
+
+	// The key waits for its value, which may be off the projection.
+	if (projection_) {
+		if (frames_.empty ())
+			return false;
+
+		member_ = projection_->member (frames_.back ().node, key_);
+		return true;
+	}
+
+	add_key (key_);
 	return true;
 }
 
 bool JSON_Parser::handle_end_map_i ()
 {
-	return pop_current ();
+	if (skipped_) {
+		--skipped_;
+		return true;
+	}
+
+	if (frames_.empty () || !frames_.back ().object)
+		return false;
+
+	const Frame f = frames_.back ();
+	frames_.pop_back ();
+	const size_t n = values_.size () - f.values;
+	if (keys_.size () - f.keys != n)
+		return false;
+
+	Object obj (resource_);
+#ifdef BJSON_FLAT_OBJECT
+	// Records of an array mostly have the same keys, keep one key array
+	// for all of them.
+	const Object* like = nullptr;
+	if (!frames_.empty () && !frames_.back ().object &&
+		f.values > frames_.back ().values &&
+		values_[f.values - 1].type () == obj_type)
+		like = &static_cast<const Value&> (values_[f.values - 1]).get_obj ();
+
+	obj.assign_unsorted (keys_.begin () + f.keys, values_.begin () + f.values, n, like);
+#else
+	for (size_t i = 0; i < n; ++i)
+		obj.insert_or_assign (obj.end (),
+			std::move (keys_[f.keys + i]), std::move (values_[f.values + i]));
+#endif // BJSON_FLAT_OBJECT
+
+	keys_.resize (f.keys);
+	values_.resize (f.values);
+
+	// The parser holds no reference into a completed container, copies of
+	// the result may share it.
+	Value v (std::move (obj));
+	v.make_shareable ();
+	add (std::move (v));
+	return true;
 }
 
 bool JSON_Parser::handle_start_array_i ()
 {
-	return prepare_structured_value<Array> (current_, key_);
+	if (projection_ && (skipped_ || !keep (true))) {
+		++skipped_;
+		return true;
+	}
+
+	frames_.push_back (Frame {values_.size (), keys_.size (), false, node_, 0});
+	return true;
 }
 
 bool JSON_Parser::handle_end_array_i ()
 {
-	return pop_current ();
+	if (skipped_) {
+		--skipped_;
+		return true;
+	}
+
+	if (frames_.empty () || frames_.back ().object)
+		return false;
+
+	const Frame f = frames_.back ();
+	frames_.pop_back ();
+
+	Array arr (resource_);
+	arr.reserve (values_.size () - f.values);
+	for (auto i = values_.begin () + f.values; i != values_.end (); ++i)
+		arr.push_back (std::move (*i));
+
+	values_.resize (f.values);
+
+	Value v (std::move (arr));
+	if (!pack_arrays_ || !v.pack_array ())
+		v.make_shareable ();
+
+	add (std::move (v));
+	return true;
+}
+
+void JSON_Parser::add (Value&& val)
+{
+	if (!frames_.empty ())
+		values_.push_back (std::move (val));
+	else if (result_)
+		*result_ = std::move (val);
+}
+
+void JSON_Parser::add_key (string_view key)
+{
+#ifdef BJSON_INTERNED_KEYS
+	if (!intern_keys_) {
+		keys_.emplace_back (key);
+		return;
+	}
+
+	auto it = key_cache_.find (key);
+	if (it == key_cache_.end ()) {
+		Object::key_type k = Object::key_type::intern (key);
+		it = key_cache_.emplace (string_view (k), k).first;
+	}
+	keys_.push_back (it->second);
+#else
+	keys_.emplace_back (key);
+#endif // BJSON_INTERNED_KEYS
+}
+
+// Projection node of the value about to start.
+uint32_t JSON_Parser::next_node () const
+{
+	if (frames_.empty ())
+		return bjson::Projection::root;
+
+	const Frame& f = frames_.back ();
+	return f.object ? member_ : projection_->element (f.node, f.index);
+}
+
+// A value starts, false if it is off the projection. Otherwise node_ is
+// its node, and its key, or null in place of the elements skipped before
+// it, is added.
+bool JSON_Parser::keep (bool container)
+{
+	const uint32_t node = next_node ();
+	const bool kept = node != bjson::Projection::none &&
+		(container || projection_->whole (node));
+
+	if (!frames_.empty ()) {
+		Frame& f = frames_.back ();
+		const size_t index = f.object ? 0 : f.index++;
+		if (!kept)
+			return false;
+
+		if (f.object)
+			add_key (key_);
+		else
+			values_.resize (max (values_.size (), f.values + index));
+	}
+
+	node_ = node;
+	return kept;
 }
 
-bool JSON_Parser::pop_current ()
+bool JSON_Parser::skip_value (bool container)
 {
-	if (current_.empty ())
+	if (!projection_)
 		return false;
 
-	current_.pop ();
+	const uint32_t node = next_node ();
+	if (node != bjson::Projection::none &&
+		(container || projection_->whole (node)))
+		return false;
+
+	if (!frames_.empty () && !frames_.back ().object)
+		++frames_.back ().index;
+
 	return true;
 }
 
 void JSON_Parser::result (json_spirit::Value* val)
 {
 	if (val) {
-		while (!current_.empty ())
-			current_.pop ();
-		current_.push (val);
+		result_ = val;
+		frames_.clear ();
+		values_.clear ();
+		keys_.clear ();
+		skipped_ = 0;
+
+#ifdef BJSON_INTERNED_KEYS
+		key_cache_.clear ();
+#endif // BJSON_INTERNED_KEYS
 	}
 }
 
+void JSON_Parser::result (json_spirit::Value* val, std::pmr::memory_resource* mr)
+{
+	resource (mr);
+	result (val);
+}
+
+void JSON_Parser::resource (std::pmr::memory_resource* mr)
+{
+	resource_ = mr ? mr : std::pmr::get_default_resource ();
+}
+
+void JSON_Parser::intern_keys (bool on)
+{
+#ifdef BJSON_INTERNED_KEYS
+	intern_keys_ = on;
+	if (!on)
+		key_cache_.clear ();
+#else
+	ACE_UNUSED_ARG (on);
+#endif // BJSON_INTERNED_KEYS
+}
+
+void JSON_Parser::pack_arrays (bool on)
+{
+	pack_arrays_ = on;
+}
+
+void JSON_Parser::projection (const bjson::Projection* projection)
+{
+	projection_ = projection;
+	skipped_ = 0;
+}
+
 size_t JSON_Parser::levels() const
 {
-	return current_.size();
+	return frames_.size();
 }
 
 const string& JSON_Parser::key() const
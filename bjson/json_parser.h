@@ -12,8 +12,16 @@
 #include "scrt/yajl_handler.h"
 #include "scrt/ctor_dtor_macros.h"
 
-#include <stack>
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bjson {
+class Projection;
+}
 
 class JSON_SPIRIT_Export JSON_Parser: public YAJL_Handler
 {
@@ -21,6 +29,37 @@ public:
     DEFAULT_CTOR_DTOR_DECLARES(JSON_Parser);
     void result(json_spirit::Value*);
 
+    /// \brief Parse into \a val, allocating its containers and strings
+    ///        from \a mr.
+    void result(json_spirit::Value* val, std::pmr::memory_resource* mr);
+
+    /// \brief Allocate containers and strings of the result from \a mr.
+    void resource(std::pmr::memory_resource* mr);
+
+    /// \brief Take object keys from the global interning table, so every
+    ///        record of a parse shares one buffer per distinct key.
+    ///
+    /// Only effective when built with BJSON_INTERNED_KEYS, otherwise each
+    /// key stays a private std::string.
+    void intern_keys(bool on);
+
+    /// \brief Store arrays holding only integers, or only reals, packed,
+    ///        see Value::pack_array().
+    void pack_arrays(bool on);
+
+    /// \brief Build only the values \a projection reaches, see
+    ///        bjson::Projection, null builds every value.
+    ///
+    /// The other values are still handed over by the reader and dropped
+    /// on arrival. \a projection must outlive the parse.
+    void projection(const bjson::Projection* projection);
+
+    /// \brief Whether the value about to start is off the projection.
+    ///
+    /// A reader able to pass over a value without handing over its events
+    /// calls it at the start of each value, and on true does so.
+    bool skip_value(bool container);
+
     virtual bool handle_null_i();
     virtual bool handle_boolean_i(bool val);
     virtual bool handle_number_i(const char* val, size_t len);
@@ -35,10 +74,52 @@ public:
     const std::string& key() const;
 
 protected:
-    bool pop_current();
+    // Containers are built when they end, their members wait on values_
+    // meanwhile, and the keys of object members on keys_ in the same order.
+    struct Frame
+    {
+        size_t values;
+        size_t keys;
+        bool object;
+
+        // Projection node of the container, and elements of an array seen
+        // so far.
+        uint32_t node;
+        size_t index;
+    };
+
+    void add(json_spirit::Value&& val);
+    void add_key(std::string_view key);
+
+    uint32_t next_node() const;
+    bool keep(bool container);
+
+    json_spirit::Value* result_ = nullptr;
+    std::vector<Frame> frames_;
+    std::vector<json_spirit::Value> values_;
+    std::vector<json_spirit::Object::key_type> keys_;
 
-    std::stack<json_spirit::Value*> current_;
     std::string key_;
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+    bool pack_arrays_ = false;
+
+    const bjson::Projection* projection_ = nullptr;
+
+    // Containers open inside a value off the projection.
+    size_t skipped_ = 0;
+
+    // Projection nodes of the member whose key was handled last, and of
+    // the value kept last.
+    uint32_t member_ = 0;
+    uint32_t node_ = 0;
+
+#ifdef BJSON_INTERNED_KEYS
+    bool intern_keys_ = false;
+
+    // Keys already taken from the table during this parse, it saves the
+    // lock of the table for every repetition. Views refer to the handles.
+    std::unordered_map<std::string_view, json_spirit::Object::key_type> key_cache_;
+#endif // BJSON_INTERNED_KEYS
 };
 
 #endif /* JSON_PARSER_H */
@@ -144,6 +144,12 @@ JSON_Pointer::JSON_Pointer(const char* val, bool log, bool copy)
         path(val, copy);
 }
 
+JSON_Pointer::JSON_Pointer(std::string_view val, bool log)
+    : log_(log)
+{
+    path(val);
+}
+
 void JSON_Pointer::path(const char* val, bool copy)
 {
     CHECK_PTR(val);
@@ -160,6 +166,15 @@ void JSON_Pointer::path(const char* val, bool copy)
     }
 }
 
+void JSON_Pointer::path(std::string_view val)
+{
+    if (!path_ || val.size() > strlen(path_))
+        buf_ = make_unique<char[]>(val.size() + 1);
+
+    path_buf_.assign(val.data(), val.size());
+    path_ = path_buf_.c_str();
+}
+
 const char* JSON_Pointer::path() const
 {
     return path_;
@@ -710,9 +725,6 @@ JSON_POINTER_MOVEABLE_SET_DEFINE(secure_string)
 
 #define JSON_POINTER_TAKE_REF_T(TYPE, VALUE) &VALUE
 
-#define JSON_POINTER_MOVE_CONST_CAST(TARGET, VALUE) \
-    std::move( const_cast<TARGET>( (VALUE) ) )
-
 #define JSON_POINTER_GET_TYPE_DEFINE_III(INPUT_TYPE, TARGET_TYPE, JSON_TYPE, RETRIEVE_FUNC, OPERATOR, INIT) \
 bool JSON_Pointer::get(INPUT_TYPE doc, TARGET_TYPE val) const \
 { \
@@ -743,7 +755,7 @@ bool JSON_Pointer::get(INPUT_TYPE doc, TARGET_TYPE val) const \
     JSON_POINTER_GET_TYPE_DEFINE_I(const Array&,  TARGET_TYPE &, JSON_TYPE, RETRIEVE_FUNC)
 
 #define JSON_POINTER_MOVABLE_GET_DEFINE_I(T1, T2, T3, T4) \
-    JSON_POINTER_GET_TYPE_DEFINE_II(T1, T2, T3, T4, JSON_POINTER_MOVE_CONST_CAST)
+    JSON_POINTER_GET_TYPE_DEFINE_II(T1, T2, T3, T4, JSON_POINTER_MOVE)
 
 #define JSON_POINTER_MOVABLE_GET_DEFINE(TARGET_TYPE, JSON_TYPE, RETRIEVE_FUNC) \
     JSON_POINTER_GET_DEFINE(TARGET_TYPE, JSON_TYPE, RETRIEVE_FUNC) \
@@ -12,6 +12,7 @@
 
 #include <ace/Auto_Ptr.h>
 #include <memory>
+#include <string_view>
 #include <type_traits>
 
 namespace json_spirit {
@@ -20,8 +21,14 @@ class JSON_SPIRIT_Export JSON_Pointer {
 public:
     JSON_Pointer() = default;
     explicit JSON_Pointer(const char* path, bool log = false, bool copy = true);
+    explicit JSON_Pointer(std::string_view path, bool log = false);
 
     void path(const char* path, bool copy = true);
+
+    /// Copy \a path, which need not be NUL terminated. The copy reuses the
+    /// buffer of the previous path, so resetting a member pointer does not
+    /// allocate once it has grown to the longest path.
+    void path(std::string_view path);
     const char* path() const;
 
     #define JSON_POINTER_SET_DECLARE(TYPE) \
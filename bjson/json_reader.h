@@ -15,7 +15,20 @@ class JSON_SPIRIT_Export JSON_Reader: public JSON_Parser
 {
 public:
     enum Flag {
-        FG_LOGGING = (1 << 0)
+        FG_LOGGING = (1 << 0),
+
+        /// Intern object keys, see JSON_Parser::intern_keys(), it is read
+        /// by loads_json() and load_json().
+        FG_INTERN_KEYS = (1 << 1),
+
+        /// Pack arrays of only integers or only reals, see
+        /// JSON_Parser::pack_arrays(), it is read by loads_json() and
+        /// load_json().
+        FG_PACK_ARRAYS = (1 << 2),
+
+        /// Parse with JSON_Index_Reader instead of yajl, it is read by
+        /// loads_json() and load_json().
+        FG_STRUCTURAL_INDEX = (1 << 3)
     };
 
     JSON_Reader();
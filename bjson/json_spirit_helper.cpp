@@ -1,6 +1,7 @@
 #include "json_spirit_helper.h"
 
 #include "dump.h"
+#include "number_format.h"
 
 #include "scrt/http_helpers.h"
 #include "scrt/time_helper.h"
@@ -13,9 +14,46 @@ using namespace std;
 
 namespace json_spirit {
 
-bool object_get(const Object& obj, const String_type& name, Value& val)
+#ifdef BJSON_FLAT_OBJECT
+static bool same_key(const Key& name, const Object::key_type& key)
 {
-    const auto i = obj.find(name);
+#ifdef BJSON_INTERNED_KEYS
+    if (name.hash() != key.hash())
+        return false;
+#endif // BJSON_INTERNED_KEYS
+
+    return name.str() == string_view(key);
+}
+
+// Objects parsed from similar records share their key layout, so the slot
+// \a name was found at last time is tried before searching.
+template <class O>
+static auto find_member(O& obj, const Key& name) -> decltype(obj.begin())
+{
+    const size_t hint = name.hint();
+    if (hint < obj.size()) {
+        const auto i = obj.begin() + hint;
+        if (same_key(name, i->first))
+            return i;
+    }
+
+    const auto i = obj.find(name.str());
+    if (i != obj.end())
+        name.hint(i - obj.begin());
+
+    return i;
+}
+#else
+template <class O>
+static auto find_member(O& obj, const Key& name) -> decltype(obj.begin())
+{
+    return obj.find(name.str());
+}
+#endif // BJSON_FLAT_OBJECT
+
+bool object_get(const Object& obj, const Key& name, Value& val)
+{
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return false;
 
@@ -23,9 +61,9 @@ bool object_get(const Object& obj, const String_type& name, Value& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, String_type& val)
+bool object_get(const Object& obj, const Key& name, String_type& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != str_type)
         return false;
 
@@ -33,9 +71,9 @@ bool object_get(const Object& obj, const String_type& name, String_type& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, secure_string& val)
+bool object_get(const Object& obj, const Key& name, secure_string& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != secure_str_type)
         return false;
 
@@ -43,9 +81,9 @@ bool object_get(const Object& obj, const String_type& name, secure_string& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, int& val)
+bool object_get(const Object& obj, const Key& name, int& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -53,9 +91,9 @@ bool object_get(const Object& obj, const String_type& name, int& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, unsigned& val)
+bool object_get(const Object& obj, const Key& name, unsigned& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -64,9 +102,9 @@ bool object_get(const Object& obj, const String_type& name, unsigned& val)
 }
 
 #if __SIZEOF_LONG__ == 4
-bool object_get(const Object& obj, const String_type& name, long& val)
+bool object_get(const Object& obj, const Key& name, long& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -74,9 +112,9 @@ bool object_get(const Object& obj, const String_type& name, long& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, unsigned long& val)
+bool object_get(const Object& obj, const Key& name, unsigned long& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -86,9 +124,9 @@ bool object_get(const Object& obj, const String_type& name, unsigned long& val)
 #endif // __SIZEOF_LONG__ == 4
 
 bool object_get(
-    const Object& obj, const String_type& name, int64_t& val)
+    const Object& obj, const Key& name, int64_t& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -97,9 +135,9 @@ bool object_get(
 }
 
 bool object_get(
-    const Object& obj, const String_type& name, uint64_t& val)
+    const Object& obj, const Key& name, uint64_t& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -107,9 +145,9 @@ bool object_get(
     return true;
 }
 
-bool object_get_ex(const Object& obj, const String_type& name, bool& val)
+bool object_get_ex(const Object& obj, const Key& name, bool& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != int_type)
         return false;
 
@@ -117,12 +155,12 @@ bool object_get_ex(const Object& obj, const String_type& name, bool& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, bool& val)
+bool object_get(const Object& obj, const Key& name, bool& val)
 {
     if (object_get_ex(obj, name, val))
         return true;
 
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != bool_type)
         return false;
 
@@ -130,9 +168,9 @@ bool object_get(const Object& obj, const String_type& name, bool& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, Object& val)
+bool object_get(const Object& obj, const Key& name, Object& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != obj_type)
         return false;
 
@@ -140,9 +178,9 @@ bool object_get(const Object& obj, const String_type& name, Object& val)
     return true;
 }
 
-bool object_get(const Object& obj, const String_type& name, Array& val)
+bool object_get(const Object& obj, const Key& name, Array& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != array_type)
         return false;
 
@@ -150,18 +188,18 @@ bool object_get(const Object& obj, const String_type& name, Array& val)
     return true;
 }
 
-bool object_get_time_t(const Object& obj, const String_type& name, time_t& val)
+bool object_get_time_t(const Object& obj, const Key& name, time_t& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != str_type
                    ? false
                    : iso8601_to_posix_time(
                             i->second.get_str().c_str(), val);
 }
 
-bool object_get_swap(Object& obj, const String_type& name, Object& val)
+bool object_get_swap(Object& obj, const Key& name, Object& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != obj_type)
         return false;
 
@@ -169,9 +207,9 @@ bool object_get_swap(Object& obj, const String_type& name, Object& val)
     return true;
 }
 
-bool object_get_swap(Object& obj, const String_type& name, Array& val)
+bool object_get_swap(Object& obj, const Key& name, Array& val)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end() || i->second.type() != array_type)
         return false;
 
@@ -180,195 +218,195 @@ bool object_get_swap(Object& obj, const String_type& name, Array& val)
 }
 
 const Value& object_get_value_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     return i->second;
 }
 
 Value& object_get_value_or_throw(
-    Object& obj, const String_type& name)
+    Object& obj, const Key& name)
 {
-    auto i = obj.find(name);
+    auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     return i->second;
 }
 
 const String_type& object_get_str_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not string type in JSON object!"));
 
     return i->second.get_str();
 }
 
 const String_type& object_get_str_or_throw(
-    const Object& obj, const String_type& name, const String_type& default_)
+    const Object& obj, const Key& name, const String_type& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not string type in JSON object!"));
 
     return i->second.get_str();
 }
 
 String_type& object_get_str_or_throw(
-    Object& obj, const String_type& name)
+    Object& obj, const Key& name)
 {
-    auto i = obj.find(name);
+    auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not string type in JSON object!"));
 
     return i->second.get_str();
 }
 
 String_type& object_get_str_or_throw(
-    Object& obj, const String_type& name, String_type& default_)
+    Object& obj, const Key& name, String_type& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not string type in JSON object!"));
 
     return i->second.get_str();
 }
 
 const secure_string& object_get_secure_str_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != secure_str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not secure string type in JSON object!"));
 
     return i->second.get_secure_str();
 }
 
 const secure_string& object_get_secure_str_or_throw(
-    const Object& obj, const String_type& name, const secure_string& default_)
+    const Object& obj, const Key& name, const secure_string& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != secure_str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not secure string type in JSON object!"));
 
     return i->second.get_secure_str();
 }
 
 secure_string& object_get_secure_str_or_throw(
-    Object& obj, const String_type& name)
+    Object& obj, const Key& name)
 {
-    auto i = obj.find(name);
+    auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != secure_str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not secure string type in JSON object!"));
 
     return i->second.get_secure_str();
 }
 
 secure_string& object_get_secure_str_or_throw(
-    Object& obj, const String_type& name, secure_string& default_)
+    Object& obj, const Key& name, secure_string& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != secure_str_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not secure string type in JSON object!"));
 
     return i->second.get_secure_str();
 }
 
-int object_get_int_or_throw(const Object& obj, const String_type& name)
+int object_get_int_or_throw(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != int_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not integer type in JSON object!"));
 
     return i->second.get_int();
 }
 
-unsigned object_get_uint_or_throw(const Object& obj, const String_type& name)
+unsigned object_get_uint_or_throw(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != int_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not integer type in JSON object!"));
 
     return i->second.get_uint();
 }
 
 #if __SIZEOF_LONG__ == 4
-long object_get_long_or_throw(const Object& obj, const String_type& name)
+long object_get_long_or_throw(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != int_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not integer type in JSON object!"));
 
     return i->second.get_long();
 }
 
-unsigned long object_get_ulong_or_throw(const Object& obj, const String_type& name)
+unsigned long object_get_ulong_or_throw(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != int_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not integer type in JSON object!"));
 
     return i->second.get_ulong();
@@ -376,196 +414,197 @@ unsigned long object_get_ulong_or_throw(const Object& obj, const String_type& na
 #endif // __SIZEOF_LONG__ == 4
 
 int64_t object_get_int64_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != int_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not integer type in JSON object!"));
 
     return i->second.get_int64();
 }
 
 uint64_t object_get_uint64_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != int_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not integer type in JSON object!"));
 
     return i->second.get_uint64();
 }
 
 const Array& object_get_array_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != array_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not array type in JSON object!"));
 
     return i->second.get_array();
 }
 
 const Array& object_get_array_or_throw(
-    const Object& obj, const String_type& name, const Array& default_)
+    const Object& obj, const Key& name, const Array& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != array_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not array type in JSON object!"));
 
     return i->second.get_array();
 }
 
 Array& object_get_array_or_throw(
-    Object& obj, const String_type& name)
+    Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != array_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not array type in JSON object!"));
 
     return i->second.get_array();
 }
 
 Array& object_get_array_or_throw(
-    Object& obj, const String_type& name, Array& default_)
+    Object& obj, const Key& name, Array& default_)
 {
-    auto i = obj.find(name);
+    auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != array_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not array type in JSON object!"));
 
     return i->second.get_array();
 }
 
 const Object& object_get_object_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != obj_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not object type in JSON object!"));
 
     return i->second.get_obj();
 }
 
 const Object& object_get_object_or_throw(
-    const Object& obj, const String_type& name, const Object& default_)
+    const Object& obj, const Key& name, const Object& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != obj_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not object type in JSON object!"));
 
     return i->second.get_obj();
 }
 
-Object& object_get_object_or_throw(Object& obj, const String_type& name)
+Object& object_get_object_or_throw(Object& obj, const Key& name)
 {
-    const Object::iterator i = obj.find(name);
+    const Object::iterator i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != obj_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not object type in JSON object!"));
 
     return i->second.get_obj();
 }
 
 Object& object_get_object_or_throw(
-    Object& obj, const String_type& name, Object& default_)
+    Object& obj, const Key& name, Object& default_)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
         return default_;
 
     if (i->second.type() != obj_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not object type in JSON object!"));
 
     return i->second.get_obj();
 }
 
 bool object_get_bool_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != bool_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not bool type in JSON object!"));
 
     return i->second.get_bool();
 }
 
-const Value* object_get_value(const Object& obj, const String_type& name)
+const Value* object_get_value(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     return i == obj.end() ? 0 : &i->second;
 }
 
-Value* object_get_value(Object& obj, const String_type& name)
+Value* object_get_value(Object& obj, const Key& name)
 {
-    return (Value*)object_get_value((const Object&)obj, name);
+    auto i = find_member(obj, name);
+    return i == obj.end() ? 0 : &i->second;
 }
 
 String_type* object_get_str(
-    Object& obj, const String_type& name)
+    Object& obj, const Key& name)
 {
-    auto i = obj.find(name);
+    auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != str_type
                    ? nullptr
                    : &i->second.get_str();
 }
 
 const String_type* object_get_str(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != str_type
                    ? nullptr
                    : &i->second.get_str();
 }
 
 const char* object_get_cstr(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
     const auto str = object_get_str(obj, name);
     return str ? str->c_str() : 0;
@@ -573,54 +612,60 @@ const char* object_get_cstr(
 
 
 secure_string* object_get_secure_str(
-    Object& obj, const String_type& name)
+    Object& obj, const Key& name)
 {
-    auto i = obj.find(name);
+    auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != secure_str_type
                    ? nullptr
                    : &i->second.get_secure_str();
 }
 
 const secure_string* object_get_secure_str(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != secure_str_type
                    ? nullptr
                    : &i->second.get_secure_str();
 }
 
 const char* object_get_secure_cstr(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
     const auto str = object_get_secure_str(obj, name);
     return str ? str->c_str() : 0;
 }
 
-const Object* object_get_object(const Object& obj, const String_type& name)
+const Object* object_get_object(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != obj_type
                   ? nullptr
                   : &i->second.get_obj();
 }
 
-Object* object_get_object(Object& obj, const String_type& name)
+Object* object_get_object(Object& obj, const Key& name)
 {
-    return (Object*)object_get_object((const Object&)obj, name);
+    auto i = find_member(obj, name);
+    return i == obj.end() || i->second.type() != obj_type
+                  ? nullptr
+                  : &i->second.get_obj();
 }
 
-const Array* object_get_array(const Object& obj, const String_type& name)
+const Array* object_get_array(const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     return i == obj.end() || i->second.type() != array_type
                    ? nullptr
                    : &i->second.get_array();
 }
 
-Array* object_get_array(Object& obj, const String_type& name)
+Array* object_get_array(Object& obj, const Key& name)
 {
-    return (Array*)object_get_array((const Object&)obj, name);
+    auto i = find_member(obj, name);
+    return i == obj.end() || i->second.type() != array_type
+                   ? nullptr
+                   : &i->second.get_array();
 }
 
 void format_str_by_obj(const json_spirit::Object& params, String_type& buf)
@@ -630,13 +675,13 @@ void format_str_by_obj(const json_spirit::Object& params, String_type& buf)
         const string& key = i.first;
         const Value& val = i.second;
         switch (val.type()) {
-        case json_spirit::int_type:
-            if (val.is_uint64())
-                tpl(key, val.get_uint64());
-            else
-                tpl(key, val.get_int64());
-
+        case json_spirit::int_type: {
+            char num[bjson::number_buffer_size];
+            *(val.is_uint64() ? bjson::format_uint64(num, val.get_uint64())
+                              : bjson::format_int64(num, val.get_int64())) = '\0';
+            tpl(key, num);
             break;
+        }
         case json_spirit::str_type:
             tpl(key, val.get_str());
             break;
@@ -644,9 +689,12 @@ void format_str_by_obj(const json_spirit::Object& params, String_type& buf)
             ACE_ERROR((LM_CRITICAL,
                        "String template not support secure string.\n"));
             break;
-        case json_spirit::real_type:
-            tpl(key, val.get_real());
+        case json_spirit::real_type: {
+            char num[bjson::number_buffer_size];
+            *bjson::format_double(num, val.get_real()) = '\0';
+            tpl(key, num);
             break;
+        }
         case json_spirit::null_type:
             tpl(key, "null");
             break;
@@ -663,26 +711,26 @@ void format_str_by_obj(const json_spirit::Object& params, String_type& buf)
 }
 
 double object_get_real_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     if (i->second.type() != real_type)
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not real type in JSON object!"));
 
     return i->second.get_real();
 }
 
 uint64_t object_get_num_or_throw(
-    const Object& obj, const String_type& name)
+    const Object& obj, const Key& name)
 {
-    const auto i = obj.find(name);
+    const auto i = find_member(obj, name);
     if (i == obj.end())
-        throw domain_error(string("No attribute '") + name
+        throw domain_error(string("No attribute '").append(name)
             + string("' in JSON object!"));
 
     switch (i->second.type()) {
@@ -691,7 +739,7 @@ uint64_t object_get_num_or_throw(
     case real_type:
         return i->second.get_real();
     default:
-        throw domain_error(string("Attribute '") + name
+        throw domain_error(string("Attribute '").append(name)
             + string("' is not int64 or real type in JSON object!"));
     }
 }
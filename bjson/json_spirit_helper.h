@@ -9,58 +9,63 @@
 
 #include "json_spirit_export.h"
 #include "json_spirit_value.h"
+#include "key.h"
 
 namespace json_spirit {
 
+// Member names are taken as Key, which converts from std::string,
+// std::string_view and string literals.
+using bjson::Key;
+
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, Value& val);
+bool object_get(const Object& obj, const Key& name, Value& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, String_type& val);
+bool object_get(const Object& obj, const Key& name, String_type& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, secure_string& val);
+bool object_get(const Object& obj, const Key& name, secure_string& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, int& val);
+bool object_get(const Object& obj, const Key& name, int& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, unsigned& val);
+bool object_get(const Object& obj, const Key& name, unsigned& val);
 
 #if __SIZEOF_LONG__ == 4
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, long& val);
+bool object_get(const Object& obj, const Key& name, long& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, unsigned long& val);
+bool object_get(const Object& obj, const Key& name, unsigned long& val);
 #endif // __SIZEOF_LONG__ == 4
 
 JSON_SPIRIT_Export
 bool object_get(
-    const Object& obj, const String_type& name, int64_t& val);
+    const Object& obj, const Key& name, int64_t& val);
 
 JSON_SPIRIT_Export
 bool object_get(
-    const Object& obj, const String_type& name, uint64_t& val);
+    const Object& obj, const Key& name, uint64_t& val);
 
 JSON_SPIRIT_Export
-bool object_get_ex(const Object& obj, const String_type& name, bool& val);
+bool object_get_ex(const Object& obj, const Key& name, bool& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, bool& val);
+bool object_get(const Object& obj, const Key& name, bool& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, Object& val);
+bool object_get(const Object& obj, const Key& name, Object& val);
 
 JSON_SPIRIT_Export
-bool object_get(const Object& obj, const String_type& name, Array& val);
+bool object_get(const Object& obj, const Key& name, Array& val);
 
 JSON_SPIRIT_Export
 bool object_get_time_t(
-    const Object& obj, const String_type& name, time_t& val);
+    const Object& obj, const Key& name, time_t& val);
 
 template <typename T>
-bool object_get(const Object& obj, const String_type& name, T& val)
+bool object_get(const Object& obj, const Key& name, T& val)
 {
     int64_t int64_val;
     if (!object_get(obj, name, int64_val))
@@ -71,155 +76,155 @@ bool object_get(const Object& obj, const String_type& name, T& val)
 
 
 JSON_SPIRIT_Export
-bool object_get_swap(Object& obj, const String_type& name, Object& val);
+bool object_get_swap(Object& obj, const Key& name, Object& val);
 
 JSON_SPIRIT_Export
-bool object_get_swap(Object& obj, const String_type& name, Array& val);
+bool object_get_swap(Object& obj, const Key& name, Array& val);
 
 
 JSON_SPIRIT_Export
 const Value& object_get_value_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 Value& object_get_value_or_throw(
-    Object& obj, const String_type& name);
+    Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 const String_type& object_get_str_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 const String_type& object_get_str_or_throw(
-    const Object& obj, const String_type& name, const String_type& default_);
+    const Object& obj, const Key& name, const String_type& default_);
 
 JSON_SPIRIT_Export
 String_type& object_get_str_or_throw(
-    Object& obj, const String_type& name);
+    Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 String_type& object_get_str_or_throw(
-    Object& obj, const String_type& name, String_type& default_);
+    Object& obj, const Key& name, String_type& default_);
 
 JSON_SPIRIT_Export
 const secure_string& object_get_secure_str_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 const secure_string& object_get_secure_str_or_throw(
-    const Object& obj, const String_type& name, const secure_string& default_);
+    const Object& obj, const Key& name, const secure_string& default_);
 
 JSON_SPIRIT_Export
 secure_string& object_get_secure_str_or_throw(
-    Object& obj, const String_type& name);
+    Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 secure_string& object_get_secure_str_or_throw(
-    Object& obj, const String_type& name, secure_string& default_);
+    Object& obj, const Key& name, secure_string& default_);
 
 JSON_SPIRIT_Export
-int object_get_int_or_throw(const Object& obj, const String_type& name);
+int object_get_int_or_throw(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-unsigned object_get_uint_or_throw(const Object& obj, const String_type& name);
+unsigned object_get_uint_or_throw(const Object& obj, const Key& name);
 
 #if __SIZEOF_LONG__ == 4
 JSON_SPIRIT_Export
-long object_get_long_or_throw(const Object& obj, const String_type& name);
+long object_get_long_or_throw(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-unsigned long object_get_ulong_or_throw(const Object& obj, const String_type& name);
+unsigned long object_get_ulong_or_throw(const Object& obj, const Key& name);
 #endif // __SIZEOF_LONG__ == 4
 
 JSON_SPIRIT_Export
 int64_t object_get_int64_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 uint64_t object_get_uint64_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 const Array& object_get_array_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 const Array& object_get_array_or_throw(
-    const Object& obj, const String_type& name, const Array& default_);
+    const Object& obj, const Key& name, const Array& default_);
 
 JSON_SPIRIT_Export
 Array& object_get_array_or_throw(
-    Object& obj, const String_type& name);
+    Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 Array& object_get_array_or_throw(
-    Object& obj, const String_type& name, Array& default_);
+    Object& obj, const Key& name, Array& default_);
 
 JSON_SPIRIT_Export
 const Object& object_get_object_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 const Object& object_get_object_or_throw(
-    const Object& obj, const String_type& name, const Object& default_);
+    const Object& obj, const Key& name, const Object& default_);
 
 JSON_SPIRIT_Export
 Object& object_get_object_or_throw(
-    Object& obj, const String_type& name);
+    Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 Object& object_get_object_or_throw(
-    Object& obj, const String_type& name, Object& default_);
+    Object& obj, const Key& name, Object& default_);
 
 JSON_SPIRIT_Export
 bool object_get_bool_or_throw(
-    const Object& obj, const String_type& name);
+    const Object& obj, const Key& name);
 
 
 JSON_SPIRIT_Export
-const Value* object_get_value(const Object& obj, const String_type& name);
+const Value* object_get_value(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-Value* object_get_value(Object& obj, const String_type& name);
+Value* object_get_value(Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-String_type* object_get_str(Object& obj, const String_type& name);
+String_type* object_get_str(Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-const String_type* object_get_str(const Object& obj, const String_type& name);
+const String_type* object_get_str(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-const char* object_get_cstr(const Object& obj, const String_type& name);
+const char* object_get_cstr(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-secure_string* object_get_secure_str(Object& obj, const String_type& name);
+secure_string* object_get_secure_str(Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-const secure_string* object_get_secure_str(const Object& obj, const String_type& name);
+const secure_string* object_get_secure_str(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-const char* object_get_secure_cstr(const Object& obj, const String_type& name);
+const char* object_get_secure_cstr(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-const Object* object_get_object(const Object& obj, const String_type& name);
+const Object* object_get_object(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-Object* object_get_object(Object& obj, const String_type& name);
+Object* object_get_object(Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-const Array* object_get_array(const Object& obj, const String_type& name);
+const Array* object_get_array(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-Array* object_get_array(Object& obj, const String_type& name);
+Array* object_get_array(Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
 void format_str_by_obj(const json_spirit::Object& params, String_type& buf);
 
 JSON_SPIRIT_Export
-double object_get_real_or_throw(const Object& obj, const String_type& name);
+double object_get_real_or_throw(const Object& obj, const Key& name);
 
 JSON_SPIRIT_Export
-uint64_t object_get_num_or_throw(const Object& obj, const String_type& name);
+uint64_t object_get_num_or_throw(const Object& obj, const Key& name);
 
 } // namespace json_spirit
 
@@ -1,6 +1,7 @@
 #include "json_string_template.h"
 
 #include "dump.h"
+#include "number_format.h"
 
 #include <ace/Log_Msg.h>
 #include <boost/algorithm/string/replace.hpp>
@@ -38,13 +39,19 @@ JSON_String_Template::operator () (const string& key, const Value& val)
     case json_spirit::bool_type:
         Super::operator()(key, val.get_bool());
         break;
-    case json_spirit::int_type:
-        val.is_uint64() ? Super::operator()(key, val.get_uint64()) :
-                          Super::operator()(key, val.get_int64());
+    case json_spirit::int_type: {
+        char buf[bjson::number_buffer_size];
+        *(val.is_uint64() ? bjson::format_uint64(buf, val.get_uint64())
+                          : bjson::format_int64(buf, val.get_int64())) = '\0';
+        Super::operator()(key, buf);
         break;
-    case json_spirit::real_type:
-        Super::operator()(key, val.get_real());
+    }
+    case json_spirit::real_type: {
+        char buf[bjson::number_buffer_size];
+        *bjson::format_double(buf, val.get_real()) = '\0';
+        Super::operator()(key, buf);
         break;
+    }
     case json_spirit::null_type:
         Super::operator()(key, "NULL");
         break;
@@ -0,0 +1,163 @@
+/// \file key.h
+/// \brief Object member name prepared once for repeated lookups.
+#ifndef BJSON_KEY_H
+#define BJSON_KEY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+// Only flat objects of interned keys read the hash of a Key.
+#if defined(BJSON_FLAT_OBJECT) && defined(BJSON_INTERNED_KEYS)
+#define BJSON_KEY_HASHED
+#endif
+
+namespace bjson {
+
+/// \brief 64 bits FNV-1a, usable in constant expressions.
+///
+/// Interned_String hashes its text with it too, so a Key and an interned
+/// key of the same text have the same hash.
+constexpr size_t hash_key(std::string_view str) noexcept
+{
+    uint64_t h = 14695981039346656037ull;
+    for (const char c : str) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+
+    return static_cast<size_t>(h);
+}
+
+/// \brief Name of an Object member prepared for repeated lookups.
+///
+/// A Key refers to its text, it does not copy it. Lookups in flat objects
+/// of interned keys compare hashes before text, in that build the hash is
+/// computed up front, at compile time for a constexpr Key:
+///
+///     static constexpr bjson::Key user_id("user_id");
+///     object_get_int64_or_throw(request, user_id);
+///
+/// Lookups through a Key also remember where the member was found. Objects
+/// parsed from the same kind of record share their key layout, so the
+/// next lookup of the Key in another record usually checks a single slot
+/// instead of searching.
+///
+/// The other builds never read the hash, hash() computes it when asked.
+class Key
+{
+public:
+    constexpr Key(std::string_view str) noexcept
+        : str_(str),
+#ifdef BJSON_KEY_HASHED
+          hash_(hash_key(str)),
+#endif // BJSON_KEY_HASHED
+          hint_(0)
+    {
+    }
+
+    constexpr Key(const char* str) noexcept
+        : Key(std::string_view(str))
+    {
+    }
+
+    /// std::string, Interned_String and other string classes.
+    template <class S,
+              class = typename std::enable_if<
+                  std::is_class<S>::value &&
+                  std::is_convertible<const S&, std::string_view>::value>::type>
+    Key(const S& str) noexcept
+        : Key(std::string_view(str))
+    {
+    }
+
+    Key(const Key& rhs) noexcept
+        : str_(rhs.str_),
+#ifdef BJSON_KEY_HASHED
+          hash_(rhs.hash_),
+#endif // BJSON_KEY_HASHED
+          hint_(rhs.hint())
+    {
+    }
+
+    Key& operator=(const Key& rhs) noexcept
+    {
+        str_ = rhs.str_;
+#ifdef BJSON_KEY_HASHED
+        hash_ = rhs.hash_;
+#endif // BJSON_KEY_HASHED
+        hint(rhs.hint());
+        return *this;
+    }
+
+    constexpr std::string_view str() const noexcept { return str_; }
+    constexpr const char* data() const noexcept { return str_.data(); }
+    constexpr size_t size() const noexcept { return str_.size(); }
+    constexpr bool empty() const noexcept { return str_.empty(); }
+
+    constexpr size_t hash() const noexcept
+    {
+#ifdef BJSON_KEY_HASHED
+        return hash_;
+#else
+        return hash_key(str_);
+#endif // BJSON_KEY_HASHED
+    }
+
+    constexpr operator std::string_view() const noexcept { return str_; }
+
+    /// \brief Position the member was last found at, it may be stale.
+    size_t hint() const noexcept
+    {
+        return hint_.load(std::memory_order_relaxed);
+    }
+
+    void hint(size_t pos) const noexcept
+    {
+        hint_.store(static_cast<uint32_t>(pos), std::memory_order_relaxed);
+    }
+
+    friend constexpr bool operator==(const Key& a, const Key& b) noexcept
+    {
+#ifdef BJSON_KEY_HASHED
+        if (a.hash_ != b.hash_)
+            return false;
+#endif // BJSON_KEY_HASHED
+
+        return a.str_ == b.str_;
+    }
+
+    friend constexpr bool operator!=(const Key& a, const Key& b) noexcept
+    {
+        return !(a == b);
+    }
+
+private:
+    std::string_view str_;
+#ifdef BJSON_KEY_HASHED
+    size_t hash_;
+#endif // BJSON_KEY_HASHED
+
+    // Only a guess, shared by the threads using a static Key.
+    mutable std::atomic<uint32_t> hint_;
+};
+
+} // namespace bjson
+
+namespace std {
+
+template <>
+struct hash<bjson::Key>
+{
+    size_t operator()(const bjson::Key& key) const noexcept
+    {
+        return key.hash();
+    }
+};
+
+} // namespace std
+
+#endif // BJSON_KEY_H
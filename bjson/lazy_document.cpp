@@ -0,0 +1,345 @@
+#include "lazy_document.h"
+#include "json_index_reader.h"
+#include "structural_index.h"
+#include "text_util.h"
+
+#include <ace/Log_Msg.h>
+#include <charconv>
+#include <limits>
+
+using namespace std;
+
+namespace bjson {
+
+namespace {
+
+// Key of a member, and element of an array, besides the token of a key.
+const uint32_t no_key = numeric_limits<uint32_t>::max();
+const uint32_t element = no_key - 1;
+
+using detail::is_space;
+
+// Array index of a segment, digits without a leading zero.
+bool parse_index(string_view segment, size_t& index)
+{
+    if (segment.empty() || (segment[0] == '0' && segment.size() > 1))
+        return false;
+
+    const char* const end = segment.data() + segment.size();
+    const auto r = from_chars(segment.data(), end, index);
+    return r.ec == errc() && r.ptr == end;
+}
+
+} // namespace
+
+Lazy_Value::Lazy_Value(const Lazy_Document* doc, uint32_t token, uint32_t key)
+    : doc_(doc),
+      token_(token),
+      key_(key)
+{
+}
+
+Lazy_Value::operator bool() const
+{
+    return doc_ != nullptr;
+}
+
+Vtype Lazy_Value::type() const
+{
+    if (!doc_)
+        return null_type;
+
+    switch (doc_->at(token_)) {
+    case '{':
+        return obj_type;
+    case '[':
+        return array_type;
+    case '"':
+        return str_type;
+    case 't':
+    case 'f':
+        return bool_type;
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return text().find_first_of(".eE") == string_view::npos ? int_type
+                                                                : real_type;
+    default:
+        return null_type;
+    }
+}
+
+string_view Lazy_Value::text() const
+{
+    if (!doc_)
+        return string_view();
+
+    const char* const buf = doc_->buf_;
+    const vector<uint32_t>& index = doc_->index_;
+    const uint32_t after = doc_->skip(token_);
+    const char c = doc_->at(token_);
+    const char* const begin = buf + index[token_];
+    const char* end = buf + doc_->len_;
+    if (c == '{' || c == '[') {
+        // Up to the closing bracket, the rest of the text if there is none.
+        const char close = doc_->at(after - 1);
+        if (after - 1 != token_ && (close == '}' || close == ']'))
+            end = buf + index[after - 1] + 1;
+    } else {
+        if (after < index.size())
+            end = buf + index[after];
+
+        while (end != begin && is_space(end[-1]))
+            --end;
+    }
+
+    return string_view(begin, end - begin);
+}
+
+Lazy_Value Lazy_Value::operator[](string_view key) const
+{
+    if (!doc_ || doc_->at(token_) != '{')
+        return Lazy_Value();
+
+    // The whole object is walked, the last of equal keys wins.
+    Lazy_Value found;
+    for (Lazy_Value m = first(); m; m = m.next()) {
+        const string_view raw = m.raw_key();
+        const bool escaped = raw.find('\\') != string_view::npos;
+        if (escaped ? string_view(m.key()) == key : raw == key)
+            found = m;
+    }
+
+    return found;
+}
+
+Lazy_Value Lazy_Value::operator[](size_t index) const
+{
+    if (!doc_ || doc_->at(token_) != '[')
+        return Lazy_Value();
+
+    Lazy_Value e = first();
+    for (; e && index; --index)
+        e = e.next();
+
+    return e;
+}
+
+Lazy_Value Lazy_Value::find(string_view pointer) const
+{
+    if (!pointer.empty() && pointer[0] != '/')
+        return Lazy_Value();
+
+    Lazy_Value val = *this;
+    while (val && !pointer.empty()) {
+        pointer.remove_prefix(1);
+        const size_t slash = pointer.find('/');
+        const string_view segment = pointer.substr(0, slash);
+        pointer.remove_prefix(slash == string_view::npos ? pointer.size() : slash);
+
+        size_t index;
+        if (val.type() == array_type)
+            val = parse_index(segment, index) ? val[index] : Lazy_Value();
+        else if (segment.find('~') == string_view::npos)
+            val = val[segment];
+        else
+            val = val[detail::unescape_segment(segment)];
+    }
+
+    return val;
+}
+
+size_t Lazy_Value::size() const
+{
+    size_t n = 0;
+    for (Lazy_Value v = first(); v; v = v.next())
+        ++n;
+
+    return n;
+}
+
+Lazy_Value Lazy_Value::first() const
+{
+    if (!doc_)
+        return Lazy_Value();
+
+    switch (doc_->at(token_)) {
+    case '{':
+        return member(token_ + 1);
+    case '[':
+        if (token_ + 1 < doc_->index_.size() && doc_->at(token_ + 1) != ']')
+            return Lazy_Value(doc_, token_ + 1, element);
+
+        return Lazy_Value();
+    default:
+        return Lazy_Value();
+    }
+}
+
+Lazy_Value Lazy_Value::next() const
+{
+    if (!doc_ || key_ == no_key)
+        return Lazy_Value();
+
+    const uint32_t after = doc_->skip(token_);
+    if (doc_->at(after) != ',')
+        return Lazy_Value();
+
+    if (key_ != element)
+        return member(after + 1);
+
+    if (after + 1 < doc_->index_.size())
+        return Lazy_Value(doc_, after + 1, element);
+
+    return Lazy_Value();
+}
+
+string Lazy_Value::key() const
+{
+    const string_view raw = raw_key();
+    if (raw.find('\\') == string_view::npos)
+        return string(raw);
+
+    // Escapes are decoded by parsing the key as a string value.
+    Value val;
+    JSON_Index_Reader reader;
+    reader.result(&val);
+    const uint32_t* const token = doc_->index_.data() + key_;
+    if (!reader.read(doc_->buf_, doc_->len_, token, token + 1, 0))
+        return string();
+
+    return val.get_str();
+}
+
+bool Lazy_Value::get(Value& val, int flags) const
+{
+    if (!doc_)
+        return false;
+
+    val = Value();
+    JSON_Index_Reader reader;
+    reader.result(&val);
+    reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+    reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+    const uint32_t* const index = doc_->index_.data();
+    return reader.read(doc_->buf_,
+                       doc_->len_,
+                       index + token_,
+                       index + doc_->skip(token_),
+                       flags);
+}
+
+// The member whose key is token key, if the text has one there.
+Lazy_Value Lazy_Value::member(uint32_t key) const
+{
+    if (doc_->at(key) != '"' || doc_->at(key + 1) != ':' ||
+        key + 2 >= doc_->index_.size())
+        return Lazy_Value();
+
+    return Lazy_Value(doc_, key + 2, key);
+}
+
+// Text of the key between its quotes, escapes not decoded.
+string_view Lazy_Value::raw_key() const
+{
+    if (!doc_ || key_ == no_key || key_ == element)
+        return string_view();
+
+    const char* const begin = doc_->buf_ + doc_->index_[key_] + 1;
+    const char* end = doc_->buf_ + doc_->index_[key_ + 1];
+    while (end != begin && is_space(end[-1]))
+        --end;
+
+    return string_view(begin, end != begin ? end - begin - 1 : 0);
+}
+
+Lazy_Document::Lazy_Document() = default;
+
+Lazy_Document::~Lazy_Document() = default;
+
+bool Lazy_Document::parse(const char* buf, size_t len, int flags)
+{
+    clear();
+    if (!buf || !len || len >= numeric_limits<uint32_t>::max() ||
+        !structural_index(buf, len, index_) || index_.empty()) {
+        if (flags & JSON_Reader::FG_LOGGING)
+            ACE_ERROR((LM_ERROR,
+                       ACE_TEXT("Failed to index JSON of %u bytes, it is "
+                                "empty, too large or a string is not "
+                                "closed\n"),
+                       static_cast<unsigned>(len)));
+
+        clear();
+        return false;
+    }
+
+    buf_ = buf;
+    len_ = len;
+    return true;
+}
+
+bool Lazy_Document::load(const char* path, int flags)
+{
+    clear();
+    unique_ptr<ACE_Mem_Map> map(new ACE_Mem_Map);
+    if (!detail::map_file(path, flags, *map) ||
+        !parse((const char*)map->addr(), map->size(), flags))
+        return false;
+
+    map_ = std::move(map);
+    return true;
+}
+
+Lazy_Value Lazy_Document::root() const
+{
+    return index_.empty() ? Lazy_Value() : Lazy_Value(this, 0, no_key);
+}
+
+Lazy_Value Lazy_Document::find(string_view pointer) const
+{
+    return root().find(pointer);
+}
+
+void Lazy_Document::clear()
+{
+    buf_ = nullptr;
+    len_ = 0;
+    index_.clear();
+    map_.reset();
+}
+
+char Lazy_Document::at(uint32_t token) const
+{
+    return token < index_.size() ? buf_[index_[token]] : '\0';
+}
+
+// Brackets are counted, the tokens in between are not looked at.
+uint32_t Lazy_Document::skip(uint32_t token) const
+{
+    const char c = at(token);
+    if (c != '{' && c != '[')
+        return token + 1;
+
+    const uint32_t n = static_cast<uint32_t>(index_.size());
+    size_t depth = 1;
+    while (++token < n) {
+        switch (buf_[index_[token]]) {
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (!--depth)
+                return token + 1;
+
+            break;
+        default:
+            break;
+        }
+    }
+
+    return n;
+}
+
+} // namespace bjson
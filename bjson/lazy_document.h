@@ -0,0 +1,152 @@
+/// \file lazy_document.h
+/// \brief JSON text navigated in place, values are built on demand.
+#ifndef BJSON_LAZY_DOCUMENT_H
+#define BJSON_LAZY_DOCUMENT_H
+
+#include "bjson_export.h"
+#include "bjson_value.h"
+#include "json_reader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ACE_Mem_Map;
+
+namespace bjson {
+
+class Lazy_Document;
+
+/// \brief Cursor on a value of a Lazy_Document.
+///
+/// It is a position in the text, cheap to copy, and stays valid as long as
+/// its document is not cleared, parsed again or destroyed. Looking up a
+/// member or an element passes over the siblings before it token by token,
+/// without looking at their bytes. A cursor that refers to nothing, e.g.
+/// the result of a failed lookup, converts to false and every lookup on it
+/// fails too, so lookups chain:
+///
+///     if (auto id = doc.root()["user"]["id"])
+///         id.get(val);
+class BJSON_EXPORT Lazy_Value
+{
+public:
+    Lazy_Value() = default;
+
+    explicit operator bool() const;
+
+    /// \brief Type of the value as the text reads, int_type for numbers
+    ///        without fraction nor exponent. null_type for no value.
+    Vtype type() const;
+
+    /// \brief JSON text of the value, as it is in the document.
+    std::string_view text() const;
+
+    /// \brief Member \a key of an object, the last one of equal keys like
+    ///        the parsers keep.
+    Lazy_Value operator[](std::string_view key) const;
+
+    /// \brief Element \a index of an array.
+    Lazy_Value operator[](size_t index) const;
+
+    /// \brief Value at the JSON pointer \a pointer from this one, "" for
+    ///        this one.
+    Lazy_Value find(std::string_view pointer) const;
+
+    /// \brief Members of an object or elements of an array, 0 otherwise.
+    size_t size() const;
+
+    /// \brief First member or element, to iterate with next().
+    Lazy_Value first() const;
+
+    /// \brief Member or element after this one in its container.
+    Lazy_Value next() const;
+
+    /// \brief Key of a member, "" otherwise.
+    std::string key() const;
+
+    /// \brief Build the value and its subtree into \a val.
+    ///
+    /// The text of the value is parsed completely, from the tokens already
+    /// found, so the value is checked as loads_json() checks a text.
+    /// JSON_Reader::FG_INTERN_KEYS and JSON_Reader::FG_PACK_ARRAYS apply.
+    bool get(Value& val, int flags = JSON_Reader::FG_LOGGING) const;
+
+private:
+    friend class Lazy_Document;
+
+    Lazy_Value(const Lazy_Document* doc, uint32_t token, uint32_t key);
+
+    Lazy_Value member(uint32_t key) const;
+    std::string_view raw_key() const;
+
+    const Lazy_Document* doc_ = nullptr;
+
+    // Tokens of the value and of the key of a member.
+    uint32_t token_ = 0;
+    uint32_t key_ = 0;
+};
+
+/// \brief JSON text kept as it is, values are found and built only when
+///        asked for.
+///
+/// For read once requests of which a handful of values are read, building
+/// the whole tree is overkill. Lazy_Document only finds the tokens of the
+/// text, with the SIMD pass of JSON_Index_Reader, then Lazy_Value cursors
+/// walk them on demand and get() builds just the values asked for:
+///
+///     Lazy_Document doc;
+///     if (!doc.load("/path/to/big.json"))
+///         return;
+///
+///     Value name;
+///     doc.find("/users/3/name").get(name);
+///
+/// The text is checked only as far as it is built: strings have to be
+/// closed for the tokens to be found, and get() rejects a malformed value,
+/// but a value passed over is not checked.
+class BJSON_EXPORT Lazy_Document
+{
+public:
+    Lazy_Document();
+    ~Lazy_Document();
+
+    Lazy_Document(const Lazy_Document&) = delete;
+    Lazy_Document& operator=(const Lazy_Document&) = delete;
+
+    /// \brief Find the tokens of \a buf, which the document refers to
+    ///        without copying it, and must outlive it.
+    bool parse(const char* buf, size_t len, int flags = JSON_Reader::FG_LOGGING);
+
+    /// \brief Map the file at \a path in memory, like load_json(), and find
+    ///        its tokens. The document keeps the mapping.
+    bool load(const char* path, int flags = JSON_Reader::FG_LOGGING);
+
+    /// \brief The top level value.
+    Lazy_Value root() const;
+
+    /// \brief root().find(pointer).
+    Lazy_Value find(std::string_view pointer) const;
+
+    /// \brief Drop the tokens and the mapping, cursors become invalid.
+    void clear();
+
+private:
+    friend class Lazy_Value;
+
+    char at(uint32_t token) const;
+
+    // Token after the value at token.
+    uint32_t skip(uint32_t token) const;
+
+    const char* buf_ = nullptr;
+    size_t len_ = 0;
+    std::vector<uint32_t> index_;
+    std::unique_ptr<ACE_Mem_Map> map_;
+};
+
+} // namespace bjson
+
+#endif // BJSON_LAZY_DOCUMENT_H
@@ -1,13 +1,13 @@
 #include "load.h"
+#include "json_index_reader.h"
+#include "reclaimer.h"
+#include "text_util.h"
 #if !defined (__ACE_INLINE__)
 #   include "load.inl"
 #endif // __ACE_INLINE__
 
-#include "scrt/check_macros.h"
-#include "scrt/compat_open.h"
-
 #include <ace/Log_Msg.h>
-#include <ace/Mem_Map.h>
+#include <limits>
 
 using namespace json_spirit;
 using namespace std;
@@ -17,21 +17,53 @@ JSON_Load::JSON_Load(const string& str)
 {
 }
 
-DEFAULT_DTOR_DEFINE(JSON_Load);
+// A loaded document may be large, destroy it off this thread if a
+// reclaimer runs.
+JSON_Load::~JSON_Load()
+{
+    bjson::reclaim(std::move(val_));
+}
 
 bool loads_json(const char* json_str, size_t len, Value& json, int flags)
+{
+    return loads_json(json_str, len, json, nullptr, flags);
+}
+
+namespace {
+
+bool parse(const char* json_str,
+           size_t len,
+           Value& json,
+           std::pmr::memory_resource* mr,
+           const bjson::Projection* projection,
+           int flags)
 {
     if (!json_str || !*json_str)
         return false;
 
-    JSON_Reader reader;
-    if (!reader.open())
-        ACE_ERROR_RETURN((LM_ERROR, "Failed to open JSON_Reader\n"), false);
-
     json = Value::null;
-    reader.result(&json);
-    if (!reader.read(json_str, len, flags) ||
-            !reader.read(nullptr, 0, flags)) {
+    bool ok;
+    if ((flags & JSON_Reader::FG_STRUCTURAL_INDEX) &&
+            len < numeric_limits<uint32_t>::max()) {
+        JSON_Index_Reader reader;
+        reader.result(&json, mr);
+        reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+        reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+        reader.projection(projection);
+        ok = reader.read(json_str, len, flags);
+    } else {
+        JSON_Reader reader;
+        if (!reader.open())
+            ACE_ERROR_RETURN((LM_ERROR, "Failed to open JSON_Reader\n"), false);
+
+        reader.result(&json, mr);
+        reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+        reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+        reader.projection(projection);
+        ok = reader.read(json_str, len, flags) && reader.read(nullptr, 0, flags);
+    }
+
+    if (!ok) {
         if (flags & JSON_Reader::FG_LOGGING)
             ACE_ERROR((LM_ERROR,
                        "Failed to load json string: %.*s\n",
@@ -43,6 +75,26 @@ bool loads_json(const char* json_str, size_t len, Value& json, int flags)
     return true;
 }
 
+} // namespace
+
+bool loads_json(const char* json_str,
+                size_t len,
+                Value& json,
+                std::pmr::memory_resource* mr,
+                int flags)
+{
+    return parse(json_str, len, json, mr, nullptr, flags);
+}
+
+bool loads_json(const char* json_str,
+                size_t len,
+                Value& json,
+                const bjson::Projection& projection,
+                int flags)
+{
+    return parse(json_str, len, json, nullptr, &projection, flags);
+}
+
 bool loads_json(const char* json_str, Value& json)
 {
     return loads_json(json_str, strlen(json_str), json);
@@ -50,27 +102,27 @@ bool loads_json(const char* json_str, Value& json)
 
 bool load_json(const char* path, Value& json, int flags)
 {
-    CHECK_C_STR_RETURN(path, false);
-
-    ACE_Mem_Map map;
-    if (map.map(path,
-                size_t(-1),
-                O_RDONLY,
-                ACE_DEFAULT_FILE_PERMS,
-                PROT_READ) < 0) {
-        if (flags & JSON_Reader::FG_LOGGING)
-            ACE_ERROR((LM_ERROR,
-                       "Failed to load %s into memory, errno=%d, %m\n",
-                       path, ACE_OS::last_error()));
-
-        return false;
-    }
+    return load_json(path, json, nullptr, flags);
+}
 
-#ifndef _WIN32
-    enable_fd_cloexec(map.handle());
-#endif // !_WIN32
+bool load_json(const char* path,
+               Value& json,
+               std::pmr::memory_resource* mr,
+               int flags)
+{
+    return bjson::detail::load_mapped(path, flags, [&](const char* buf, size_t len) {
+        return loads_json(buf, len, json, mr, flags);
+    });
+}
 
-    return loads_json((const char*)map.addr(), map.size(), json);
+bool load_json(const char* path,
+               Value& json,
+               const bjson::Projection& projection,
+               int flags)
+{
+    return bjson::detail::load_mapped(path, flags, [&](const char* buf, size_t len) {
+        return loads_json(buf, len, json, projection, flags);
+    });
 }
 
 // vim: set et ts=4 sts=4 sw=4:
@@ -4,6 +4,7 @@
 #define JSON_SPIRIT_LOAD_H
 
 #include "json_reader.h"
+#include "projection.h"
 #include "scrt/compat_features.h"
 
 class JSON_SPIRIT_Export JSON_Load
@@ -38,11 +39,64 @@ JSON_SPIRIT_Export bool loads_json(const char* json_str,
 JSON_SPIRIT_Export bool loads_json(const char* json_str,
                                    json_spirit::Value& json);
 
+/// \brief load JSON string into containers allocated from \a mr
+///
+/// Example, one pool per request, released when the request is done:
+///
+/// void Handler::handle(const Request& req)
+/// {
+///     std::pmr::unsynchronized_pool_resource pool;
+///     json_spirit::Value params;
+///     if (!loads_json(req.body(), req.length(), params, &pool))
+///         return;
+///
+///     ...
+/// }   // params is destroyed before pool, which frees its blocks at once
+///
+/// \note \a mr must outlive \a json, and copies of \a json are allocated
+///       from the default resource.
+JSON_SPIRIT_Export bool loads_json(const char* json_str,
+                                   size_t len,
+                                   json_spirit::Value& json,
+                                   std::pmr::memory_resource* mr,
+                                   int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief load only the values \a projection reaches from JSON string
+///
+/// Example, two fields out of a large payload:
+///
+/// static const bjson::Projection fields{"/user/id", "/order/total"};
+///
+/// json_spirit::Value doc;
+/// if (!loads_json(body, len, doc, fields))
+///     return;
+///
+/// JSON_Pointer("/order/total").get(doc, total);
+///
+/// \see bjson::Projection for the shape of the result.
+JSON_SPIRIT_Export bool loads_json(const char* json_str,
+                                   size_t len,
+                                   json_spirit::Value& json,
+                                   const bjson::Projection& projection,
+                                   int flags = JSON_Reader::FG_LOGGING);
+
 /// \brief load JSON from file
 JSON_SPIRIT_Export bool load_json(const char* path,
                                   json_spirit::Value& json,
                                   int flags = JSON_Reader::FG_LOGGING);
 
+/// \brief load JSON from file into containers allocated from \a mr
+JSON_SPIRIT_Export bool load_json(const char* path,
+                                  json_spirit::Value& json,
+                                  std::pmr::memory_resource* mr,
+                                  int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief load only the values \a projection reaches from file
+JSON_SPIRIT_Export bool load_json(const char* path,
+                                  json_spirit::Value& json,
+                                  const bjson::Projection& projection,
+                                  int flags = JSON_Reader::FG_LOGGING);
+
 #if defined (__ACE_INLINE__)
 #   include "load.inl"
 #endif // __ACE_INLINE__
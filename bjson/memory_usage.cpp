@@ -0,0 +1,132 @@
+#include "memory_usage.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace bjson {
+
+// Heap characters of a string, none while they fit in the small string
+// buffer inside the object.
+static size_t heap_chars(const std::string& str)
+{
+    const char* self = reinterpret_cast<const char*>(&str);
+    const char* p = str.data();
+    return p >= self && p < self + sizeof(str) ? 0 : str.capacity() + 1;
+}
+
+// Boxes, key layouts and interned keys already counted.
+using Seen = std::unordered_set<const void*>;
+
+static size_t key_chars(const std::string& key, Seen&)
+{
+    return heap_chars(key);
+}
+
+#ifdef BJSON_INTERNED_KEYS
+// Counted once, every key equal to it refers to it.
+static size_t key_chars(const Interned_String& key, Seen& seen)
+{
+    return key.empty() || !seen.insert(key.data()).second
+               ? 0
+               : 2 * sizeof(size_t) + key.size() + 1;
+}
+#endif // BJSON_INTERNED_KEYS
+
+#ifndef BJSON_FLAT_OBJECT
+// Color, parent, left and right of a red black tree node.
+static const size_t map_node_links = 4 * sizeof(void*);
+#endif // BJSON_FLAT_OBJECT
+
+template <class Box>
+static void account_packed(const Box* box, Memory_Usage& usage)
+{
+    usage.overhead += sizeof(Box);
+    usage.arrays += box->vec.capacity() * sizeof(box->vec[0]);
+
+    usage.overhead += box->retired.capacity() * sizeof(box->retired[0]);
+    const auto account_view = [&usage](const auto* view) {
+        usage.overhead += sizeof(*view);
+        usage.arrays += view->value.capacity() * sizeof(Value);
+    };
+
+    if (const auto* view = box->boxed.load(std::memory_order_acquire))
+        account_view(view);
+
+    for (const auto* view : box->retired)
+        account_view(view);
+}
+
+// Depth first with a stack of its own, a tree may be too deep to recurse.
+Memory_Usage memory_usage(const Value& value)
+{
+    Memory_Usage usage;
+    Seen seen;
+    std::vector<const Value*> stack(1, &value);
+    while (!stack.empty()) {
+        const Value& val = *stack.back();
+        stack.pop_back();
+
+        switch (val.tag_) {
+        case Value::obj_tag: {
+            if (!seen.insert(val.data_.obj).second)
+                break;
+
+            const Object& obj = val.data_.obj->value;
+            usage.overhead += sizeof(Value::Obj_Box);
+#ifdef BJSON_FLAT_OBJECT
+            // Objects of the same layout share their keys.
+            const auto& keys = obj.keys();
+            if (keys.capacity() && seen.insert(&keys).second) {
+                usage.overhead += sizeof(Object::key_container_type) + 2 * sizeof(long);
+                usage.objects += keys.capacity() * sizeof(Object::key_type);
+                for (const auto& key : keys)
+                    usage.strings += key_chars(key, seen);
+            }
+
+            usage.objects += obj.values().capacity() * sizeof(Value);
+            for (const auto& i : obj)
+                stack.push_back(&i.second);
+#else
+            usage.objects += obj.size() * (map_node_links + sizeof(Object::value_type));
+            for (const auto& i : obj) {
+                usage.strings += key_chars(i.first, seen);
+                stack.push_back(&i.second);
+            }
+#endif // BJSON_FLAT_OBJECT
+            break;
+        }
+        case Value::array_tag: {
+            if (!seen.insert(val.data_.arr).second)
+                break;
+
+            const Array& arr = val.data_.arr->value;
+            usage.overhead += sizeof(Value::Arr_Box);
+            usage.arrays += arr.capacity() * sizeof(Value);
+            for (const auto& i : arr)
+                stack.push_back(&i);
+            break;
+        }
+        case Value::str_tag:
+            if (seen.insert(val.data_.str).second) {
+                usage.overhead += sizeof(Value::Str_Box);
+                usage.strings += heap_chars(val.data_.str->str);
+            }
+            break;
+        case Value::int_array_tag:
+            if (seen.insert(val.data_.ints).second)
+                account_packed(val.data_.ints, usage);
+            break;
+        case Value::real_array_tag:
+            if (seen.insert(val.data_.reals).second)
+                account_packed(val.data_.reals, usage);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return usage;
+}
+
+} // namespace bjson
@@ -0,0 +1,54 @@
+/// \file memory_usage.h
+/// \brief Bytes held by a Value tree.
+#ifndef BJSON_MEMORY_USAGE_H
+#define BJSON_MEMORY_USAGE_H
+
+#include "bjson_export.h"
+#include "bjson_value.h"
+
+#include <cstddef>
+
+namespace bjson {
+
+/// \brief Heap bytes below a Value, the Value itself excluded.
+struct Memory_Usage
+{
+    /// Characters of strings and keys not held in the small string buffer.
+    size_t strings = 0;
+
+    /// Tree nodes of objects, or key and value arrays for flat objects.
+    size_t objects = 0;
+
+    /// Element buffers of arrays, by capacity.
+    size_t arrays = 0;
+
+    /// Boxes Values keep their containers and strings in.
+    size_t overhead = 0;
+
+    size_t total() const
+    {
+        return strings + objects + arrays + overhead;
+    }
+
+    Memory_Usage& operator+=(const Memory_Usage& rhs)
+    {
+        strings += rhs.strings;
+        objects += rhs.objects;
+        arrays += rhs.arrays;
+        overhead += rhs.overhead;
+        return *this;
+    }
+};
+
+/// \brief Account the memory of \a value, e.g. to cap what a tenant may
+///        keep in parsed documents.
+///
+/// Sizes are computed from capacities rather than asked from the
+/// allocator. A box shared by copies, the keys flat objects of one layout
+/// share and an interned key are counted once, so the total is what the
+/// tree holds. Trees sharing boxes each count them in full.
+BJSON_EXPORT Memory_Usage memory_usage(const Value& value);
+
+} // namespace bjson
+
+#endif // BJSON_MEMORY_USAGE_H
@@ -0,0 +1,70 @@
+#include "number_format.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __has_include
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+namespace bjson {
+
+namespace detail {
+
+const char digit_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+} // namespace detail
+
+namespace {
+
+char* shortest(char* out, double val)
+{
+#if defined(__cpp_lib_to_chars)
+    // Shortest round trip, the Ryu algorithm in libstdc++ and libc++.
+    return std::to_chars(out, out + number_buffer_size - 3, val).ptr;
+#else
+    // The first precision reading back exactly, 17 digits always do.
+    int len = 0;
+    for (int precision = 15; precision <= 17; ++precision) {
+        len = std::snprintf(out, number_buffer_size - 2, "%.*g", precision, val);
+        if (std::strtod(out, nullptr) == val)
+            break;
+    }
+
+    return out + len;
+#endif // __cpp_lib_to_chars
+}
+
+} // namespace
+
+char* format_double(char* out, double val)
+{
+    char* const end = shortest(out, val);
+    if (!std::isfinite(val))
+        return end;
+
+    for (const char* p = out; p != end; ++p)
+        if (*p != '-' && (*p < '0' || *p > '9'))
+            return end;
+
+    std::memcpy(end, ".0", 2);
+    return end + 2;
+}
+
+} // namespace bjson
+
+// vim: set et ts=4 sts=4 sw=4:
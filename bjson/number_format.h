@@ -0,0 +1,86 @@
+/// \file number_format.h
+/// \brief Numbers written as JSON text, without printf.
+#ifndef BJSON_NUMBER_FORMAT_H
+#define BJSON_NUMBER_FORMAT_H
+
+#include "bjson_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bjson {
+
+/// \brief Size of a buffer large enough for any formatted number and the
+///        terminating '\0'.
+constexpr size_t number_buffer_size = 32;
+
+namespace detail {
+
+extern BJSON_EXPORT const char digit_pairs[200];
+
+inline unsigned count_digits(uint64_t val)
+{
+    unsigned n = 1;
+    for (;;) {
+        if (val < 10)
+            return n;
+        if (val < 100)
+            return n + 1;
+        if (val < 1000)
+            return n + 2;
+        if (val < 10000)
+            return n + 3;
+
+        val /= 10000;
+        n += 4;
+    }
+}
+
+} // namespace detail
+
+/// \brief Write \a val in decimal at \a out, two digits per division.
+/// \return The end of the digits, it is not '\0' terminated.
+inline char* format_uint64(char* out, uint64_t val)
+{
+    char* const end = out + detail::count_digits(val);
+    char* p = end;
+    while (val >= 100) {
+        p -= 2;
+        std::memcpy(p, detail::digit_pairs + (val % 100) * 2, 2);
+        val /= 100;
+    }
+
+    if (val >= 10) {
+        std::memcpy(p - 2, detail::digit_pairs + val * 2, 2);
+    } else {
+        *--p = static_cast<char>('0' + val);
+    }
+
+    return end;
+}
+
+/// \copydoc format_uint64()
+inline char* format_int64(char* out, int64_t val)
+{
+    uint64_t mag = static_cast<uint64_t>(val);
+    if (val < 0) {
+        *out++ = '-';
+        mag = 0 - mag;
+    }
+
+    return format_uint64(out, mag);
+}
+
+/// \brief Write the shortest decimal text that reads back as \a val.
+///
+/// Integral values get ".0" like yajl_gen_double() writes them, so the
+/// text is parsed back as a real. NaN and infinities are written "nan",
+/// "inf" and "-inf", they are not JSON, callers emitting JSON reject them
+/// first.
+/// \return The end of the text, it is not '\0' terminated.
+BJSON_EXPORT char* format_double(char* out, double val);
+
+} // namespace bjson
+
+#endif // BJSON_NUMBER_FORMAT_H
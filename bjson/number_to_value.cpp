@@ -1,27 +1,156 @@
 #include "number_to_value.h"
-#include "scrt/natoi.h"
-#include <ace/OS_NS_stdlib.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <limits.h>
+#include <string>
+
+#ifdef __has_include
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
 
 using namespace json_spirit;
 
+namespace {
+
+// Powers of ten exactly representable as a double.
+const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Correctly rounded like strtod(), whatever the locale.
+bool slow_real(const char* val, const char* end, bool overflow, double& d)
+{
+#if defined(__cpp_lib_to_chars)
+    const auto r = std::from_chars(val, end, d);
+    if (r.ec == std::errc::result_out_of_range) {
+        // strtod() saturates to infinity or flushes to zero.
+        d = overflow ? HUGE_VAL : 0.0;
+        if (*val == '-')
+            d = -d;
+    } else if (r.ec != std::errc() || r.ptr != end) {
+        return false;
+    }
+
+    return true;
+#else
+    (void)overflow;
+    const std::string buf(val, end);
+    char* p;
+    d = strtod(buf.c_str(), &p);
+    return p == buf.c_str() + buf.size();
+#endif // __cpp_lib_to_chars
+}
+
+} // namespace
+
 void number_to_value(const char* val, size_t len, Value& v)
 {
-    char buf[128];
-    if (len >= sizeof(buf))
+    const char* const end = val + len;
+    const char* p = val;
+    const bool neg = p != end && *p == '-';
+    if (neg)
+        ++p;
+
+    if (p == end || !is_digit(*p))
         return;
 
-    strncpy(buf, val, len)[len] = 0;
-    if (strcspn(buf, ".eE") == len) {
-        if (buf[0] == '-') {
-            const auto num = natoi<int64_t>(val, len);
-            v = num >= INT_MIN && num <= INT_MAX ? (int)num : num;
+    // Integers accumulate exactly as long as they fit 64 bits.
+    uint64_t mag = 0;
+    bool overflow = false;
+    for (; p != end && is_digit(*p); ++p)
+        overflow |= __builtin_mul_overflow(mag, 10u, &mag) |
+                    __builtin_add_overflow(mag, uint64_t(*p - '0'), &mag);
+
+    if (p == end && !overflow) {
+        if (!neg) {
+            v = mag;
+            return;
+        }
+
+        if (mag <= uint64_t(INT64_MAX) + 1) {
+            const int64_t num = static_cast<int64_t>(0 - mag);
+            v = num >= INT_MIN ? Value(static_cast<int>(num)) : Value(num);
+            return;
+        }
+    }
+
+    // Reals, and integers out of the 64 bits range. The first 19
+    // significant digits fit a uint64_t, with exp10 the power of ten
+    // to scale them by.
+    uint64_t m = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool exact = true;
+    const auto take = [&](char c, bool fraction) {
+        if (digits < 19) {
+            m = m * 10 + (c - '0');
+            if (m)
+                ++digits;
+
+            if (fraction)
+                --exp10;
         } else {
-            v = natoi<uint64_t>(val, len);
+            exact &= c == '0';
+            if (!fraction)
+                ++exp10;
         }
-    } else {
-        v = strtod(buf, 0);
+    };
+
+    for (p = neg ? val + 1 : val; p != end && is_digit(*p); ++p)
+        take(*p, false);
+
+    if (p != end && *p == '.') {
+        if (++p == end || !is_digit(*p))
+            return;
+
+        for (; p != end && is_digit(*p); ++p)
+            take(*p, true);
     }
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        bool neg_exp = false;
+        if (++p != end && (*p == '+' || *p == '-'))
+            neg_exp = *p++ == '-';
+
+        if (p == end || !is_digit(*p))
+            return;
+
+        int e = 0;
+        for (; p != end && is_digit(*p); ++p)
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+
+        exp10 += neg_exp ? -e : e;
+    }
+
+    if (p != end)
+        return;
+
+    // Clinger's fast path, a single correctly rounded operation on two
+    // exact doubles.
+    double d;
+    if (m == 0) {
+        d = neg ? -0.0 : 0.0;
+    } else if (exact && m <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        d = static_cast<double>(m);
+        d = exp10 < 0 ? d / exact_pow10[-exp10] : d * exact_pow10[exp10];
+        if (neg)
+            d = -d;
+    } else if (!slow_real(val, end, digits + exp10 > 0, d)) {
+        return;
+    }
+
+    v = d;
 }
 
 // vim: set et ts=4 sts=4 sw=4:
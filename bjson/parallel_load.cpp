@@ -0,0 +1,315 @@
+#include "parallel_load.h"
+#include "json_index_reader.h"
+#include "json_lines_reader.h"
+#include "load.h"
+#include "structural_index.h"
+#include "text_util.h"
+
+#include <ace/Log_Msg.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace json_spirit;
+using namespace std;
+
+namespace {
+
+using bjson::detail::is_space;
+
+// Chunks per thread, a thread done early takes over more of the others.
+const size_t chunks_per_thread = 8;
+
+// Smaller chunks cost more in hand-offs than they win in balance.
+const size_t min_chunk_size = 1 << 20;
+
+struct Chunk
+{
+    const char* begin;
+    const char* end;
+};
+
+using Emit = function<bool(Value& record)>;
+
+unsigned worker_count(unsigned threads)
+{
+    if (!threads)
+        threads = thread::hardware_concurrency();
+
+    return max(threads, 1u);
+}
+
+// About chunks_per_thread chunks per worker of the same size, each one
+// ending after a newline.
+vector<Chunk> split_lines(const char* buf, size_t len, unsigned workers)
+{
+    const size_t size = max(len / (workers * chunks_per_thread), min_chunk_size);
+    const char* const end = buf + len;
+
+    vector<Chunk> chunks;
+    for (const char* begin = buf; begin != end;) {
+        const char* cut = end;
+        if (static_cast<size_t>(end - begin) > size) {
+            const char* eol = static_cast<const char*>(
+                memchr(begin + size, '\n', end - begin - size));
+            if (eol)
+                cut = eol + 1;
+        }
+
+        chunks.push_back(Chunk{begin, cut});
+        begin = cut;
+    }
+
+    return chunks;
+}
+
+// work(worker, i) for every chunk i, on up to \a workers threads, the
+// caller being worker 0. Chunks not started yet are dropped once one
+// fails.
+template <class Work>
+bool run_chunks(size_t chunks, unsigned workers, Work work)
+{
+    atomic<size_t> next(0);
+    atomic<bool> failed(false);
+    const auto run = [&](unsigned worker) {
+        while (!failed.load(memory_order_relaxed)) {
+            const size_t i = next.fetch_add(1, memory_order_relaxed);
+            if (i >= chunks)
+                break;
+
+            if (!work(worker, i))
+                failed.store(true, memory_order_relaxed);
+        }
+    };
+
+    workers = static_cast<unsigned>(min<size_t>(workers, max<size_t>(chunks, 1)));
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned worker = 1; worker < workers; ++worker)
+        pool.emplace_back(run, worker);
+
+    run(0);
+    for (auto& t : pool)
+        t.join();
+
+    return !failed;
+}
+
+bool is_blank(const char* p, const char* end)
+{
+    for (; p != end; ++p)
+        if (!is_space(*p))
+            return false;
+
+    return true;
+}
+
+bool parse_lines(const Chunk& chunk, int flags, const Emit& emit)
+{
+    if (!(flags & JSON_Reader::FG_STRUCTURAL_INDEX)) {
+        JSON_Lines_Reader reader(emit);
+        reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+        reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+        return reader.open() &&
+               reader.read(chunk.begin, chunk.end - chunk.begin, flags) &&
+               reader.read(nullptr, 0, flags);
+    }
+
+    Value record;
+    JSON_Index_Reader reader;
+    reader.result(&record);
+    reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+    reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+    for (const char* p = chunk.begin; p != chunk.end;) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+        const char* const line_end = eol ? eol : chunk.end;
+        if (!is_blank(p, line_end)) {
+            if (!reader.read(p, line_end - p, flags) || !emit(record))
+                return false;
+
+            record = Value();
+        }
+
+        p = eol ? eol + 1 : chunk.end;
+    }
+
+    return true;
+}
+
+// Elements of a piece of the top level array, and the commas between
+// them, parsed as an array of their own.
+bool parse_elements(const Chunk& piece, int flags, Value& elements)
+{
+    if (flags & JSON_Reader::FG_STRUCTURAL_INDEX) {
+        string text;
+        text.reserve(piece.end - piece.begin + 2);
+        text += '[';
+        text.append(piece.begin, piece.end);
+        text += ']';
+
+        JSON_Index_Reader reader;
+        reader.result(&elements);
+        reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+        reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+        return reader.read(text.data(), text.size(), flags);
+    }
+
+    JSON_Reader reader;
+    if (!reader.open())
+        ACE_ERROR_RETURN((LM_ERROR, "Failed to open JSON_Reader\n"), false);
+
+    reader.result(&elements);
+    reader.intern_keys(flags & JSON_Reader::FG_INTERN_KEYS);
+    reader.pack_arrays(flags & JSON_Reader::FG_PACK_ARRAYS);
+    return reader.read("[", 1, flags) &&
+           reader.read(piece.begin, piece.end - piece.begin, flags) &&
+           reader.read("]", 1, flags) &&
+           reader.read(nullptr, 0, flags);
+}
+
+} // namespace
+
+bool loads_json_lines(const char* buf,
+                      size_t len,
+                      Array& records,
+                      unsigned threads,
+                      int flags)
+{
+    const unsigned workers = worker_count(threads);
+    const vector<Chunk> chunks = split_lines(buf, len, workers);
+
+    // Records of each chunk, spliced in order at the end.
+    vector<vector<Value>> parsed(chunks.size());
+    const bool ok = run_chunks(chunks.size(), workers, [&](unsigned, size_t i) {
+        vector<Value>& out = parsed[i];
+        return parse_lines(chunks[i], flags, [&out](Value& record) {
+            out.push_back(std::move(record));
+            return true;
+        });
+    });
+
+    if (!ok)
+        return false;
+
+    size_t total = records.size();
+    for (const auto& out : parsed)
+        total += out.size();
+
+    records.reserve(total);
+    for (auto& out : parsed)
+        for (auto& record : out)
+            records.push_back(std::move(record));
+
+    return true;
+}
+
+bool loads_json_lines(const char* buf,
+                      size_t len,
+                      const JSON_Record_Sink& sink,
+                      unsigned threads,
+                      int flags)
+{
+    const unsigned workers = worker_count(threads);
+    const vector<Chunk> chunks = split_lines(buf, len, workers);
+    return run_chunks(chunks.size(), workers, [&](unsigned worker, size_t i) {
+        return parse_lines(chunks[i], flags, [&sink, worker](Value& record) {
+            return sink(worker, record);
+        });
+    });
+}
+
+bool load_json_lines(const char* path,
+                     Array& records,
+                     unsigned threads,
+                     int flags)
+{
+    return bjson::detail::load_mapped(path, flags, [&](const char* buf, size_t len) {
+        return loads_json_lines(buf, len, records, threads, flags);
+    });
+}
+
+bool load_json_lines(const char* path,
+                     const JSON_Record_Sink& sink,
+                     unsigned threads,
+                     int flags)
+{
+    return bjson::detail::load_mapped(path, flags, [&](const char* buf, size_t len) {
+        return loads_json_lines(buf, len, sink, threads, flags);
+    });
+}
+
+bool loads_json_array(const char* buf,
+                      size_t len,
+                      Value& json,
+                      unsigned threads,
+                      int flags)
+{
+    const unsigned workers = worker_count(threads);
+    const size_t parts = min<size_t>(workers * chunks_per_thread,
+                                     len / min_chunk_size);
+
+    // The closing bracket of the array ends the last piece.
+    size_t close = len;
+    while (close && is_space(buf[close - 1]))
+        --close;
+
+    vector<size_t> splits;
+    if (parts < 2 || !close || buf[--close] != ']' ||
+            !bjson::array_split_points(buf, len, parts, splits) ||
+            splits.empty())
+        return loads_json(buf, len, json, flags);
+
+    vector<Chunk> pieces;
+    pieces.reserve(splits.size() + 1);
+    const char* begin = static_cast<const char*>(memchr(buf, '[', len)) + 1;
+    for (const size_t split : splits) {
+        pieces.push_back(Chunk{begin, buf + split - 1});
+        begin = buf + split;
+    }
+
+    pieces.push_back(Chunk{begin, buf + close});
+
+    // A blank piece, after a trailing or doubled comma, would parse as an
+    // empty array: loads_json() rejects the text as a whole.
+    for (const Chunk& piece : pieces)
+        if (is_blank(piece.begin, piece.end))
+            return loads_json(buf, len, json, flags);
+
+    vector<Value> parsed(pieces.size());
+    const bool ok = run_chunks(pieces.size(), workers, [&](unsigned, size_t i) {
+        return parse_elements(pieces[i], flags, parsed[i]);
+    });
+
+    if (!ok)
+        return false;
+
+    size_t total = 0;
+    for (auto& elements : parsed)
+        total += elements.get_array().size();
+
+    Array arr;
+    arr.reserve(total);
+    for (auto& elements : parsed)
+        for (auto& element : elements.get_array())
+            arr.push_back(std::move(element));
+
+    json = Value(std::move(arr));
+    if (!(flags & JSON_Reader::FG_PACK_ARRAYS) || !json.pack_array())
+        json.make_shareable();
+
+    return true;
+}
+
+bool load_json_array(const char* path,
+                     Value& json,
+                     unsigned threads,
+                     int flags)
+{
+    return bjson::detail::load_mapped(path, flags, [&](const char* buf, size_t len) {
+        return loads_json_array(buf, len, json, threads, flags);
+    });
+}
+
+// vim: set et ts=4 sts=4 sw=4:
@@ -0,0 +1,76 @@
+/// \file parallel_load.h
+/// \brief Loading large JSON inputs on several threads.
+#ifndef JSON_SPIRIT_PARALLEL_LOAD_H
+#define JSON_SPIRIT_PARALLEL_LOAD_H
+
+#include "json_reader.h"
+
+#include <functional>
+
+/// \brief Receives the records of one worker, on the thread of that worker.
+///
+/// \a worker is below the number of threads, sinks may keep per worker
+/// state without locks. A worker sees its records in input order.
+/// Returning false stops the load, which then fails.
+using JSON_Record_Sink =
+    std::function<bool(unsigned worker, json_spirit::Value& record)>;
+
+/// \brief Load JSON Lines, one record per line, on \a threads threads.
+///
+/// The text is cut at newlines into chunks parsed concurrently, by
+/// JSON_Lines_Reader or, with JSON_Reader::FG_STRUCTURAL_INDEX, by
+/// JSON_Index_Reader line by line. JSON_Reader::FG_INTERN_KEYS and
+/// JSON_Reader::FG_PACK_ARRAYS apply as for loads_json(). Records are
+/// appended to \a records in input order. Blank lines are skipped, a
+/// malformed record fails the load.
+///
+/// \param threads 0 for one per core.
+JSON_SPIRIT_Export bool loads_json_lines(const char* buf,
+                                         size_t len,
+                                         json_spirit::Array& records,
+                                         unsigned threads = 0,
+                                         int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief Load JSON Lines handing the records to \a sink as they are parsed.
+JSON_SPIRIT_Export bool loads_json_lines(const char* buf,
+                                         size_t len,
+                                         const JSON_Record_Sink& sink,
+                                         unsigned threads = 0,
+                                         int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief Load a JSON Lines file, mapped in memory like load_json().
+JSON_SPIRIT_Export bool load_json_lines(const char* path,
+                                        json_spirit::Array& records,
+                                        unsigned threads = 0,
+                                        int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief Load a JSON Lines file handing the records to \a sink.
+JSON_SPIRIT_Export bool load_json_lines(const char* path,
+                                        const JSON_Record_Sink& sink,
+                                        unsigned threads = 0,
+                                        int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief Load a JSON text, parsing the elements of a top level array on
+///        \a threads threads.
+///
+/// bjson::array_split_points() cuts the array between elements, the pieces
+/// are parsed concurrently and their elements spliced into one Array.
+/// Flags apply as for loads_json(). A text too small to split or not an
+/// array is loaded by loads_json() on the calling thread.
+///
+/// \param threads 0 for one per core.
+JSON_SPIRIT_Export bool loads_json_array(const char* buf,
+                                         size_t len,
+                                         json_spirit::Value& json,
+                                         unsigned threads = 0,
+                                         int flags = JSON_Reader::FG_LOGGING);
+
+/// \brief Load a JSON file like loads_json_array(), mapped in memory like
+///        load_json().
+JSON_SPIRIT_Export bool load_json_array(const char* path,
+                                        json_spirit::Value& json,
+                                        unsigned threads = 0,
+                                        int flags = JSON_Reader::FG_LOGGING);
+
+#endif // !JSON_SPIRIT_PARALLEL_LOAD_H
+// vim: set et ts=4 sts=4 sw=4:
@@ -0,0 +1,79 @@
+#include "projection.h"
+#include "text_util.h"
+
+#include <charconv>
+
+using namespace std;
+
+namespace bjson {
+
+Projection::Projection()
+    : nodes_(1)
+{
+}
+
+Projection::Projection(initializer_list<string_view> pointers)
+    : Projection()
+{
+    for (const string_view pointer : pointers)
+        add(pointer);
+}
+
+bool Projection::add(string_view pointer)
+{
+    if (!pointer.empty() && pointer[0] != '/')
+        return false;
+
+    uint32_t node = root;
+    while (!pointer.empty() && !nodes_[node].whole) {
+        pointer.remove_prefix(1);
+        const size_t slash = pointer.find('/');
+        const string segment = detail::unescape_segment(pointer.substr(0, slash));
+        pointer.remove_prefix(slash == string_view::npos ? pointer.size() : slash);
+
+        uint32_t next = find(node, segment);
+        if (next == none) {
+            next = static_cast<uint32_t>(nodes_.size());
+            nodes_[node].edges.push_back(Edge{segment, next});
+            nodes_.emplace_back();
+        }
+
+        node = next;
+    }
+
+    // Paths below a value taken whole are in it already.
+    nodes_[node].whole = true;
+    nodes_[node].edges.clear();
+    return true;
+}
+
+uint32_t Projection::member(uint32_t node, string_view key) const
+{
+    return nodes_[node].whole ? node : find(node, key);
+}
+
+uint32_t Projection::element(uint32_t node, size_t index) const
+{
+    if (nodes_[node].whole)
+        return node;
+
+    char buf[24];
+    const char* const end = to_chars(buf, buf + sizeof(buf), index).ptr;
+    return find(node, string_view(buf, end - buf));
+}
+
+bool Projection::whole(uint32_t node) const
+{
+    return nodes_[node].whole;
+}
+
+uint32_t Projection::find(uint32_t node, string_view segment) const
+{
+    for (const Edge& edge : nodes_[node].edges)
+        if (edge.segment == segment)
+            return edge.node;
+
+    return none;
+}
+
+} // namespace bjson
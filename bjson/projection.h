@@ -0,0 +1,85 @@
+/// \file projection.h
+/// \brief JSON pointers a parse builds, the rest of the text is skipped.
+#ifndef BJSON_PROJECTION_H
+#define BJSON_PROJECTION_H
+
+#include "bjson_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bjson {
+
+/// \brief Set of JSON pointers, the only values a parse given it builds.
+///
+/// The pointers have the syntax of JSON_Pointer. The tree parsed keeps the
+/// shape of the text along the way to each of them, so JSON_Pointer reads
+/// them from it as it would from the whole tree:
+///
+///     static const bjson::Projection fields{"/user/id", "/items/0/sku"};
+///
+///     json_spirit::Value doc;
+///     if (loads_json(body, len, doc, fields))
+///         JSON_Pointer("/user/id").get(doc, id);
+///
+/// A pointer takes the whole subtree it reaches. Objects on the way keep
+/// only the members on a path, arrays keep the elements up to the last one
+/// on a path with null in place of the others. A scalar found where a
+/// pointer goes on is dropped.
+///
+/// Values off every path are never built. JSON_Reader still lexes them
+/// but hands nothing over, JSON_Index_Reader passes over their tokens
+/// without looking at their bytes.
+class BJSON_EXPORT Projection
+{
+public:
+    /// \brief Node of the values off every path.
+    static constexpr uint32_t none = UINT32_MAX;
+
+    /// \brief Node of the top level value.
+    static constexpr uint32_t root = 0;
+
+    Projection();
+
+    /// \brief Projection of \a pointers, those add() rejects are left out.
+    Projection(std::initializer_list<std::string_view> pointers);
+
+    /// \brief Add \a pointer, "" takes the whole text.
+    /// \return false if it does not start with '/', nothing is added then.
+    bool add(std::string_view pointer);
+
+    /// \brief Node of member \a key of the object at \a node.
+    uint32_t member(uint32_t node, std::string_view key) const;
+
+    /// \brief Node of element \a index of the array at \a node.
+    uint32_t element(uint32_t node, size_t index) const;
+
+    /// \brief Whether the value at \a node is taken with its subtree.
+    bool whole(uint32_t node) const;
+
+private:
+    struct Edge
+    {
+        std::string segment;
+        uint32_t node;
+    };
+
+    // Segments are few per node, a projection names a handful of values.
+    struct Node
+    {
+        std::vector<Edge> edges;
+        bool whole = false;
+    };
+
+    uint32_t find(uint32_t node, std::string_view segment) const;
+
+    std::vector<Node> nodes_;
+};
+
+} // namespace bjson
+
+#endif // BJSON_PROJECTION_H
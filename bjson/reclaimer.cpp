@@ -0,0 +1,142 @@
+#include "reclaimer.h"
+
+#include <memory_resource>
+#include <unordered_set>
+#include <utility>
+
+namespace bjson {
+
+namespace {
+
+// Whether every box of the tree is from the new/delete resource. A value
+// moved in from an arena keeps its own resource, so the root alone does
+// not tell. A box shared at several places is walked once.
+bool from_new_delete(const Value& root)
+{
+    std::pmr::memory_resource* const heap = std::pmr::new_delete_resource();
+    std::unordered_set<const void*> seen;
+    std::vector<const Value*> stack(1, &root);
+    while (!stack.empty()) {
+        const Value& val = *stack.back();
+        stack.pop_back();
+        std::pmr::memory_resource* const mr = val.resource();
+        if (!mr)
+            continue;
+
+        if (!mr->is_equal(*heap))
+            return false;
+
+        if (val.type() == obj_type) {
+            const Object& obj = val.get_obj();
+            if (seen.insert(&obj).second)
+                for (const auto& member : obj)
+                    stack.push_back(&member.second);
+        } else if (val.type() == array_type && !val.is_int64_array() &&
+                   !val.is_real_array()) {
+            const Array& arr = val.get_array();
+            if (seen.insert(&arr).second)
+                for (const Value& element : arr)
+                    stack.push_back(&element);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+Reclaimer::~Reclaimer()
+{
+    stop();
+}
+
+Reclaimer& Reclaimer::instance()
+{
+    static Reclaimer reclaimer;
+    return reclaimer;
+}
+
+void Reclaimer::start()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    if (running_)
+        return;
+
+    running_ = true;
+    thread_ = std::thread(&Reclaimer::run, this);
+}
+
+void Reclaimer::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (!running_)
+            return;
+
+        running_ = false;
+    }
+
+    cond_.notify_one();
+    thread_.join();
+}
+
+bool Reclaimer::running() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return running_;
+}
+
+void Reclaimer::reclaim(Value&& value)
+{
+    // Scalars cost nothing to destroy, trees with a box of another resource
+    // must be destroyed by their owner. The walk is skipped when nothing
+    // would take the tree, and done outside the lock.
+    if (!value.resource() || !running() || !from_new_delete(value)) {
+        Value discard(std::move(value));
+        return;
+    }
+
+    // stop() may have run during the walk.
+    std::unique_lock<std::mutex> guard(lock_);
+    if (!running_) {
+        guard.unlock();
+        Value discard(std::move(value));
+        return;
+    }
+
+    try {
+        queue_.push_back(std::move(value));
+    } catch (...) {
+        guard.unlock();
+        Value discard(std::move(value));
+        return;
+    }
+
+    guard.unlock();
+    cond_.notify_one();
+}
+
+size_t Reclaimer::pending() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return queue_.size();
+}
+
+// Trees are taken by batch, and destroyed outside of the lock.
+void Reclaimer::run()
+{
+    std::vector<Value> batch;
+    std::unique_lock<std::mutex> guard(lock_);
+    for (;;) {
+        cond_.wait(guard, [this] { return !running_ || !queue_.empty(); });
+        if (queue_.empty())
+            break;
+
+        batch.swap(queue_);
+        guard.unlock();
+        batch.clear();
+        guard.lock();
+    }
+}
+
+} // namespace bjson
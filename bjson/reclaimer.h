@@ -0,0 +1,78 @@
+/// \file reclaimer.h
+/// \brief Destroy discarded Value trees off the request thread.
+#ifndef BJSON_RECLAIMER_H
+#define BJSON_RECLAIMER_H
+
+#include "bjson_export.h"
+#include "bjson_value.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bjson {
+
+/// \brief Background thread taking ownership of trees to destroy.
+///
+/// Freeing a large document costs as much as a walk over it, handing it
+/// to the reclaimer moves that out of the latency of the request:
+///
+///     bjson::Reclaimer::instance().start();
+///     ...
+///     bjson::reclaim(std::move(doc));
+///
+/// Only trees whose every box is from the new/delete resource are taken,
+/// a pool or an arena may not be thread safe or may be released before
+/// the thread gets to them. A tree with a single box of another resource,
+/// e.g. a value moved in from an arena, is destroyed by the caller as
+/// before. Checking that walks the containers of the tree, which is still
+/// cheaper than freeing them.
+class BJSON_EXPORT Reclaimer
+{
+public:
+    Reclaimer() = default;
+    ~Reclaimer();
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    /// \brief The one reclaim() uses.
+    static Reclaimer& instance();
+
+    /// \brief Start the thread, does nothing if it runs already.
+    void start();
+
+    /// \brief Destroy what is queued and join the thread.
+    void stop();
+
+    bool running() const;
+
+    /// \brief Take \a value, it is null afterwards.
+    ///
+    /// It is destroyed in place if the reclaimer is not running or a box
+    /// of the tree is not from the new/delete resource.
+    void reclaim(Value&& value);
+
+    /// \brief Number of trees waiting to be destroyed.
+    size_t pending() const;
+
+private:
+    void run();
+
+    mutable std::mutex lock_;
+    std::condition_variable cond_;
+    std::vector<Value> queue_;
+    std::thread thread_;
+    bool running_ = false;
+};
+
+/// \brief Destroy \a value with Reclaimer::instance().
+inline void reclaim(Value&& value)
+{
+    Reclaimer::instance().reclaim(std::move(value));
+}
+
+} // namespace bjson
+
+#endif // BJSON_RECLAIMER_H
@@ -0,0 +1,314 @@
+#include "structural_index.h"
+
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BJSON_STRUCTURAL_X86
+#include <immintrin.h>
+#endif
+
+namespace bjson {
+
+namespace {
+
+// Bit i of each mask describes byte i of a 64 bytes block.
+struct Block
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;            // all of open, close and ':' ','
+    uint64_t space;
+    uint64_t open;          // '{' '['
+    uint64_t close;         // '}' ']'
+};
+
+using Classify = void (*)(const unsigned char* p, Block& b);
+
+void classify_scalar(const unsigned char* p, Block& b)
+{
+    b = Block();
+    for (unsigned i = 0; i < 64; ++i) {
+        const uint64_t bit = uint64_t(1) << i;
+        switch (p[i]) {
+        case '"':
+            b.quote |= bit;
+            break;
+        case '\\':
+            b.backslash |= bit;
+            break;
+        case '{': case '[':
+            b.open |= bit;
+            b.op |= bit;
+            break;
+        case '}': case ']':
+            b.close |= bit;
+            b.op |= bit;
+            break;
+        case ':': case ',':
+            b.op |= bit;
+            break;
+        case ' ': case '\t': case '\n': case '\r':
+            b.space |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#ifdef BJSON_STRUCTURAL_X86
+// '[' and ']' are '{' and '}' without bit 0x20.
+#define BJSON_CLASSIFY(SET1, EQ, OR, MASK, c, bits) \
+    { \
+        const auto lower = OR(c, SET1(0x20)); \
+        quote |= bits(MASK(EQ(c, SET1('"')))); \
+        backslash |= bits(MASK(EQ(c, SET1('\\')))); \
+        open |= bits(MASK(EQ(lower, SET1('{')))); \
+        close |= bits(MASK(EQ(lower, SET1('}')))); \
+        op |= bits(MASK(OR(EQ(c, SET1(':')), EQ(c, SET1(','))))); \
+        space |= bits(MASK(OR(OR(EQ(c, SET1(' ')), EQ(c, SET1('\t'))), \
+                              OR(EQ(c, SET1('\n')), EQ(c, SET1('\r')))))); \
+    }
+
+__attribute__((target("sse2")))
+void classify_sse2(const unsigned char* p, Block& b)
+{
+    uint64_t quote = 0, backslash = 0, op = 0, space = 0, open = 0, close = 0;
+    for (unsigned i = 0; i < 64; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const auto bits = [i](int m) { return uint64_t(uint16_t(m)) << i; };
+        BJSON_CLASSIFY(_mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128,
+                       _mm_movemask_epi8, c, bits)
+    }
+
+    b = Block{quote, backslash, op | open | close, space, open, close};
+}
+
+__attribute__((target("avx2")))
+void classify_avx2(const unsigned char* p, Block& b)
+{
+    uint64_t quote = 0, backslash = 0, op = 0, space = 0, open = 0, close = 0;
+    for (unsigned i = 0; i < 64; i += 32) {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const auto bits = [i](int m) { return uint64_t(uint32_t(m)) << i; };
+        BJSON_CLASSIFY(_mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256,
+                       _mm256_movemask_epi8, c, bits)
+    }
+
+    b = Block{quote, backslash, op | open | close, space, open, close};
+}
+
+#undef BJSON_CLASSIFY
+#endif // BJSON_STRUCTURAL_X86
+
+struct Isa
+{
+    Classify classify;
+    const char* name;
+};
+
+Isa detect_isa()
+{
+#ifdef BJSON_STRUCTURAL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return {classify_avx2, "avx2"};
+
+    if (__builtin_cpu_supports("sse2"))
+        return {classify_sse2, "sse2"};
+#endif // BJSON_STRUCTURAL_X86
+
+    return {classify_scalar, "scalar"};
+}
+
+const Isa& isa()
+{
+    static const Isa detected = detect_isa();
+    return detected;
+}
+
+// Bit i is the xor of bits 0 to i, it turns quote positions into the
+// ranges between them.
+uint64_t prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// State carried from one block to the next.
+struct Carry
+{
+    uint64_t odd_backslash = 0;     // block ended in an odd backslash run
+    uint64_t in_string = 0;         // all ones if it ended inside a string
+    uint64_t scalar = 0;            // it ended in a number or a literal
+};
+
+// Bytes preceded by an odd number of backslashes, the escaped ones.
+uint64_t escaped(uint64_t backslash, Carry& carry)
+{
+    const uint64_t even_bits = 0x5555555555555555ull;
+    const uint64_t odd_bits = ~even_bits;
+
+    const uint64_t starts = backslash & ~(backslash << 1);
+    const uint64_t even_start_mask = even_bits ^ carry.odd_backslash;
+    const uint64_t even_starts = starts & even_start_mask;
+    const uint64_t odd_starts = starts & ~even_start_mask;
+
+    const uint64_t even_carries = backslash + even_starts;
+    uint64_t odd_carries = backslash + odd_starts;
+    const bool overflow = odd_carries < backslash;
+    odd_carries |= carry.odd_backslash;
+    carry.odd_backslash = overflow ? 1 : 0;
+
+    const uint64_t even_carry_ends = even_carries & ~backslash;
+    const uint64_t odd_carry_ends = odd_carries & ~backslash;
+    return (even_carry_ends & odd_bits) | (odd_carry_ends & even_bits);
+}
+
+uint64_t structurals(const Block& b, Carry& carry)
+{
+    const uint64_t quote = b.quote & ~escaped(b.backslash, carry);
+
+    // From an opening quote up to, not including, its closing quote.
+    const uint64_t in_string = prefix_xor(quote) ^ carry.in_string;
+    carry.in_string = uint64_t(int64_t(in_string) >> 63);
+
+    // A number or a literal starts where such a byte follows a byte that is
+    // not part of one.
+    const uint64_t scalar = ~(b.op | b.space | b.quote);
+    const uint64_t follows_scalar = (scalar << 1) | carry.scalar;
+    carry.scalar = scalar >> 63;
+
+    const uint64_t tokens = b.op | (scalar & ~follows_scalar);
+    return (tokens & ~in_string) | (quote & in_string);
+}
+
+void append(std::vector<uint32_t>& index, uint32_t base, uint64_t bits)
+{
+    if (!bits)
+        return;
+
+    size_t n = index.size();
+    index.resize(n + __builtin_popcountll(bits));
+    uint32_t* out = index.data() + n;
+    do {
+        *out++ = base + static_cast<uint32_t>(__builtin_ctzll(bits));
+        bits &= bits - 1;
+    } while (bits);
+}
+
+} // namespace
+
+bool structural_index(const char* buf, size_t len, std::vector<uint32_t>& index)
+{
+    index.clear();
+    if (len >= std::numeric_limits<uint32_t>::max())
+        return false;
+
+    const Classify classify = isa().classify;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(buf);
+
+    // Roughly one token per 8 bytes of usual JSON.
+    index.reserve(len / 8 + 16);
+
+    Carry carry;
+    Block b;
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        classify(p + i, b);
+        append(index, static_cast<uint32_t>(i), structurals(b, carry));
+    }
+
+    if (i < len) {
+        // Spaces end a trailing number or literal without adding tokens.
+        unsigned char tail[64];
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, p + i, len - i);
+        classify(tail, b);
+        append(index, static_cast<uint32_t>(i), structurals(b, carry));
+    }
+
+    return !carry.in_string;
+}
+
+bool array_split_points(const char* buf,
+                        size_t len,
+                        size_t parts,
+                        std::vector<size_t>& splits)
+{
+    splits.clear();
+
+    size_t start = 0;
+    while (start < len && (buf[start] == ' ' || buf[start] == '\t' ||
+                           buf[start] == '\n' || buf[start] == '\r'))
+        ++start;
+
+    if (start == len || buf[start] != '[')
+        return false;
+
+    if (parts < 2)
+        return true;
+
+    const Classify classify = isa().classify;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(buf);
+    const size_t step = len / parts;
+    size_t target = step;
+    int64_t depth = 0;
+
+    Carry carry;
+    Block b;
+    unsigned char tail[64];
+    for (size_t i = 0; i < len; i += 64) {
+        if (i + 64 <= len) {
+            classify(p + i, b);
+        } else {
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, p + i, len - i);
+            classify(tail, b);
+        }
+
+        const uint64_t quote = b.quote & ~escaped(b.backslash, carry);
+        const uint64_t in_string = prefix_xor(quote) ^ carry.in_string;
+        carry.in_string = uint64_t(int64_t(in_string) >> 63);
+
+        const uint64_t open = b.open & ~in_string;
+        const uint64_t close = b.close & ~in_string;
+
+        // Blocks before the next target only change the depth.
+        if (target >= i + 64) {
+            depth += __builtin_popcountll(open) - __builtin_popcountll(close);
+            continue;
+        }
+
+        for (uint64_t ops = b.op & ~in_string; ops; ops &= ops - 1) {
+            const unsigned bit = __builtin_ctzll(ops);
+            const uint64_t mask = uint64_t(1) << bit;
+            if (open & mask) {
+                ++depth;
+            } else if (close & mask) {
+                --depth;
+            } else if (depth == 1 && i + bit >= target && p[i + bit] == ',') {
+                splits.push_back(i + bit + 1);
+                if (splits.size() + 1 == parts)
+                    return true;
+
+                target = (splits.size() + 1) * step;
+            }
+        }
+    }
+
+    return true;
+}
+
+const char* structural_isa()
+{
+    return isa().name;
+}
+
+} // namespace bjson
@@ -0,0 +1,55 @@
+/// \file structural_index.h
+/// \brief Stage 1 of JSON_Index_Reader, positions of the tokens of a JSON
+///        text found 64 bytes at a time, and split points of large arrays.
+#ifndef BJSON_STRUCTURAL_INDEX_H
+#define BJSON_STRUCTURAL_INDEX_H
+
+#include "bjson_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bjson {
+
+/// \brief Offsets of every token start of \a buf in text order.
+///
+/// A token start is one of `{ } [ ] : ,` outside strings, the opening quote
+/// of a string, or the first byte of a number or a literal. Bytes inside
+/// strings are never reported, so a parser walking the offsets only looks
+/// at the bytes of strings, numbers and literals themselves.
+///
+/// Blocks are classified with AVX2 or SSE2 when the CPU has them, see
+/// structural_isa(), the result is the same on every path.
+///
+/// \return false if a string is not closed or \a len does not fit the
+///         32 bits offsets. \a index is cleared first.
+BJSON_EXPORT bool structural_index(const char* buf,
+                                   size_t len,
+                                   std::vector<uint32_t>& index);
+
+/// \brief Offsets just past the commas between elements of the top level
+///        array of \a buf, cutting it into about \a parts pieces of the
+///        same size.
+///
+/// Strings and escapes are told apart like structural_index() does, and
+/// only the nesting depth is kept, so it runs at the speed of the block
+/// classification until the last offset is found. The text is not
+/// validated: a malformed one gives offsets that parsing the pieces
+/// rejects, as a piece then does not end between two elements. A trailing
+/// or doubled comma may give a blank piece instead, the caller rejects it.
+///
+/// \return false if the text is not an array. \a splits is cleared first
+///         and may get fewer than \a parts - 1 offsets.
+BJSON_EXPORT bool array_split_points(const char* buf,
+                                     size_t len,
+                                     size_t parts,
+                                     std::vector<size_t>& splits);
+
+/// \brief Instruction set used by structural_index(): "avx2", "sse2" or
+///        "scalar".
+BJSON_EXPORT const char* structural_isa();
+
+} // namespace bjson
+
+#endif // BJSON_STRUCTURAL_INDEX_H
@@ -0,0 +1,55 @@
+#include "text_util.h"
+#include "json_reader.h"
+
+#include "scrt/check_macros.h"
+#include "scrt/compat_open.h"
+
+#include <ace/Log_Msg.h>
+
+namespace bjson {
+
+namespace detail {
+
+std::string unescape_segment(std::string_view segment)
+{
+    std::string out;
+    out.reserve(segment.size());
+    for (size_t i = 0; i < segment.size(); ++i) {
+        if (segment[i] == '~' && i + 1 < segment.size() &&
+            (segment[i + 1] == '1' || segment[i + 1] == '0')) {
+            out += segment[++i] == '1' ? '/' : '~';
+        } else {
+            out += segment[i];
+        }
+    }
+
+    return out;
+}
+
+bool map_file(const char* path, int flags, ACE_Mem_Map& map)
+{
+    CHECK_C_STR_RETURN(path, false);
+
+    if (map.map(path,
+                size_t(-1),
+                O_RDONLY,
+                ACE_DEFAULT_FILE_PERMS,
+                PROT_READ) < 0) {
+        if (flags & JSON_Reader::FG_LOGGING)
+            ACE_ERROR((LM_ERROR,
+                       "Failed to load %s into memory, errno=%d, %m\n",
+                       path, ACE_OS::last_error()));
+
+        return false;
+    }
+
+#ifndef _WIN32
+    enable_fd_cloexec(map.handle());
+#endif // !_WIN32
+
+    return true;
+}
+
+} // namespace detail
+
+} // namespace bjson
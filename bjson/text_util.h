@@ -0,0 +1,44 @@
+/// \file text_util.h
+/// \brief Helpers the readers and loaders of JSON text share, for the
+///        sources of the library only.
+#ifndef BJSON_TEXT_UTIL_H
+#define BJSON_TEXT_UTIL_H
+
+#include <ace/Mem_Map.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace bjson {
+
+namespace detail {
+
+/// \brief Whitespace as JSON has it.
+inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/// \brief Segment of a JSON pointer with "~1" and "~0" decoded, like
+///        JSON_Pointer does.
+std::string unescape_segment(std::string_view segment);
+
+/// \brief Map the file at \a path in memory read only, the way load_json()
+///        does, and log a failure if \a flags has JSON_Reader::FG_LOGGING.
+bool map_file(const char* path, int flags, ACE_Mem_Map& map);
+
+/// \brief Call \a load with the text of the file at \a path, mapped for
+///        the duration of the call.
+template <class Load>
+bool load_mapped(const char* path, int flags, Load load)
+{
+    ACE_Mem_Map map;
+    return map_file(path, flags, map) &&
+           load((const char*)map.addr(), map.size());
+}
+
+} // namespace detail
+
+} // namespace bjson
+
+#endif // BJSON_TEXT_UTIL_H
@@ -0,0 +1,550 @@
+#include "text_writer.h"
+#include "number_format.h"
+
+#include <ace/OS_NS_unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace bjson {
+
+namespace {
+
+// Escape of each byte as yajl_string_encode() writes it without
+// escaping '/': 0 if none, 'u' for \u00XX, else the letter after '\'.
+struct Escapes
+{
+    char table[256] = {};
+
+    Escapes()
+    {
+        for (int c = 0; c < 0x20; ++c)
+            table[c] = 'u';
+
+        table[int('\b')] = 'b';
+        table[int('\f')] = 'f';
+        table[int('\n')] = 'n';
+        table[int('\r')] = 'r';
+        table[int('\t')] = 't';
+        table[int('"')] = '"';
+        table[int('\\')] = '\\';
+    }
+};
+
+const Escapes escapes;
+
+const char hex_digits[] = "0123456789ABCDEF";
+
+// Length of the leading run of \a p needing no escape.
+inline size_t clean_run(const char* p, size_t n)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= n; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+
+        // c <= 0x1f unsigned is max(c, 0x1f) == 0x1f.
+        const __m128i special =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, quote),
+                                      _mm_cmpeq_epi8(c, backslash)),
+                         _mm_cmpeq_epi8(_mm_max_epu8(c, control), control));
+        if (const int mask = _mm_movemask_epi8(special))
+            return i + __builtin_ctz(mask);
+    }
+#endif // __SSE2__
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // 8 bytes at a time in a register. Borrows only flag bytes above the
+    // lowest flagged one, so the lowest is exact.
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t c;
+        std::memcpy(&c, p + i, 8);
+        const uint64_t q = c ^ (ones * '"');
+        const uint64_t b = c ^ (ones * '\\');
+        const uint64_t special = ((c - ones * 0x20) | (q - ones) | (b - ones)) &
+                                 ~c & highs;
+        if (special)
+            return i + __builtin_ctzll(special) / 8;
+    }
+#endif // __BYTE_ORDER__
+
+    while (i < n && !escapes.table[static_cast<unsigned char>(p[i])])
+        ++i;
+
+    return i;
+}
+
+// Size of the buffer writing to a handle, it is written out when full.
+const size_t handle_buffer_size = 64 * 1024;
+
+// Room taken past the content of a buffer at first. It then grows by as
+// much as was written, resize() zeroes what it adds so all the capacity
+// of a reused buffer is not taken at once.
+const size_t first_room = 256;
+
+// Strings are escaped by pieces of it, so the room a piece may need stays
+// small however long the string.
+const size_t string_piece = 4096;
+
+// Buffer is std::string or std::vector<char>, the text is written in its
+// free room past the current content.
+template <class Buffer>
+class Text_Writer
+{
+public:
+    Text_Writer(Buffer& out, bool beautify, ACE_HANDLE handle)
+        : out_(out),
+          start_(out.size()),
+          beautify_(beautify),
+          handle_(handle)
+    {
+        out_.resize(handle_ == ACE_INVALID_HANDLE ? start_ + first_room
+                                                  : handle_buffer_size);
+        p_ = &out_[0] + start_;
+        end_ = &out_[0] + out_.size();
+    }
+
+    // The top level value, and the newline yajl ends it with.
+    bool write(const Value& val)
+    {
+        value(val, 0);
+        if (beautify_)
+            put('\n');
+
+        return finish();
+    }
+
+private:
+    char* reserve(size_t n)
+    {
+        if (static_cast<size_t>(end_ - p_) < n)
+            grow(n);
+
+        return p_;
+    }
+
+    void grow(size_t n);
+    bool flush();
+    bool finish();
+
+    void put(char c)
+    {
+        *reserve(1) = c;
+        ++p_;
+    }
+
+    void put(const char* s, size_t n)
+    {
+        std::memcpy(reserve(n), s, n);
+        p_ += n;
+    }
+
+    void indent(unsigned depth);
+    void value(const Value& val, unsigned depth);
+    void object(const Object& obj, unsigned depth);
+    void array(const Value& val, unsigned depth);
+    void string(const char* s, size_t n);
+    void real(double d);
+
+    void open(char c);
+    void close(char c, unsigned depth);
+
+    // Separator and indentation before member or element i.
+    void next(size_t i, unsigned depth);
+
+    Buffer& out_;
+
+    // Content of out_ before the text.
+    const size_t start_;
+
+    const bool beautify_;
+    const ACE_HANDLE handle_;
+    bool failed_ = false;
+
+    // Free room of out_.
+    char* p_;
+    char* end_;
+};
+
+template <class Buffer>
+void Text_Writer<Buffer>::grow(size_t n)
+{
+    // Written out even after a failed write, so the buffer stays bounded.
+    if (handle_ != ACE_INVALID_HANDLE) {
+        flush();
+        if (static_cast<size_t>(end_ - p_) >= n)
+            return;
+    }
+
+    const size_t used = p_ - out_.data();
+    out_.resize(used + std::max(n, std::max(used - start_, first_room)));
+    p_ = &out_[0] + used;
+    end_ = &out_[0] + out_.size();
+}
+
+template <class Buffer>
+bool Text_Writer<Buffer>::flush()
+{
+    const size_t used = p_ - out_.data();
+    if (!failed_ && used &&
+            ACE_OS::write_n(handle_, out_.data(), used) != ssize_t(used))
+        failed_ = true;
+
+    p_ = &out_[0];
+    return !failed_;
+}
+
+template <class Buffer>
+bool Text_Writer<Buffer>::finish()
+{
+    if (handle_ != ACE_INVALID_HANDLE)
+        return flush();
+
+    out_.resize(p_ - out_.data());
+    return true;
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::indent(unsigned depth)
+{
+    static const char spaces[] = "                                ";
+    const size_t chunk = sizeof(spaces) - 1;
+
+    size_t n = size_t(depth) * 4;
+    char* p = reserve(n);
+    for (; n > chunk; n -= chunk, p += chunk)
+        std::memcpy(p, spaces, chunk);
+
+    std::memcpy(p, spaces, n);
+    p_ = p + n;
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::value(const Value& val, unsigned depth)
+{
+    switch (val.type()) {
+    case obj_type:
+        object(val.get_obj(), depth);
+        break;
+    case array_type:
+        array(val, depth);
+        break;
+    case str_type: {
+        const std::string& str = val.get_str();
+        string(str.data(), str.size());
+        break;
+    }
+    case bool_type:
+        if (val.get_bool())
+            put("true", 4);
+        else
+            put("false", 5);
+
+        break;
+    case int_type:
+        reserve(number_buffer_size);
+        p_ = val.is_uint64() ? format_uint64(p_, val.get_uint64())
+                             : format_int64(p_, val.get_int64());
+        break;
+    case real_type:
+        real(val.get_real());
+        break;
+    case null_type:
+        put("null", 4);
+        break;
+    }
+}
+
+// yajl_gen writes a newline after the opening bracket and another before
+// the closing one, so an empty container spans 3 lines.
+template <class Buffer>
+void Text_Writer<Buffer>::open(char c)
+{
+    put(c);
+    if (beautify_)
+        put('\n');
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::close(char c, unsigned depth)
+{
+    if (beautify_) {
+        put('\n');
+        indent(depth);
+    }
+
+    put(c);
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::next(size_t i, unsigned depth)
+{
+    if (!beautify_) {
+        if (i)
+            put(',');
+
+        return;
+    }
+
+    if (i)
+        put(",\n", 2);
+
+    indent(depth);
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::object(const Object& obj, unsigned depth)
+{
+    open('{');
+
+    size_t i = 0;
+    for (const auto& member : obj) {
+        next(i++, depth + 1);
+        string(member.first.c_str(), member.first.length());
+        if (beautify_)
+            put(": ", 2);
+        else
+            put(':');
+
+        value(member.second, depth + 1);
+    }
+
+    close('}', depth);
+}
+
+// Packed arrays are written straight from their buffer, like
+// yajl_gen_value() does.
+template <class Buffer>
+void Text_Writer<Buffer>::array(const Value& val, unsigned depth)
+{
+    open('[');
+
+    if (val.is_int64_array()) {
+        size_t i = 0;
+        for (const auto n : val.get_int64_span()) {
+            next(i++, depth + 1);
+            p_ = format_int64(reserve(number_buffer_size), n);
+        }
+    } else if (val.is_real_array()) {
+        size_t i = 0;
+        for (const auto d : val.get_real_span()) {
+            next(i++, depth + 1);
+            real(d);
+        }
+    } else {
+        size_t i = 0;
+        for (const auto& element : val.get_array()) {
+            next(i++, depth + 1);
+            value(element, depth + 1);
+        }
+    }
+
+    close(']', depth);
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::string(const char* s, size_t n)
+{
+    put('"');
+    while (n) {
+        // At worst every byte of the piece becomes \u00XX.
+        const size_t piece = std::min(n, string_piece);
+        char* p = reserve(piece * 6);
+        const char* const end = s + piece;
+        while (s != end) {
+            const size_t run = clean_run(s, end - s);
+            std::memcpy(p, s, run);
+            p += run;
+            s += run;
+            if (s == end)
+                break;
+
+            const unsigned char c = *s++;
+            const char e = escapes.table[c];
+            *p++ = '\\';
+            if (e == 'u') {
+                std::memcpy(p, "u00", 3);
+                p[3] = hex_digits[c >> 4];
+                p[4] = hex_digits[c & 0xf];
+                p += 5;
+            } else {
+                *p++ = e;
+            }
+        }
+
+        p_ = p;
+        n -= piece;
+    }
+
+    put('"');
+}
+
+template <class Buffer>
+void Text_Writer<Buffer>::real(double d)
+{
+    if (!std::isfinite(d)) {
+        put("null", 4);
+        return;
+    }
+
+    p_ = format_double(reserve(number_buffer_size), d);
+}
+
+// Sizes of what Text_Writer writes, computed the same way.
+class Size_Counter
+{
+public:
+    explicit Size_Counter(bool beautify)
+        : beautify_(beautify)
+    {
+    }
+
+    size_t size(const Value& val)
+    {
+        return value(val, 0) + (beautify_ ? 1 : 0);
+    }
+
+private:
+    size_t value(const Value& val, unsigned depth);
+    size_t string(const char* s, size_t n);
+    size_t real(double d);
+
+    // Brackets, separators and indentation of a container of n members
+    // or elements.
+    size_t container(size_t n, unsigned depth);
+
+    const bool beautify_;
+};
+
+size_t Size_Counter::value(const Value& val, unsigned depth)
+{
+    switch (val.type()) {
+    case obj_type: {
+        const Object& obj = val.get_obj();
+        size_t size = container(obj.size(), depth) +
+                      obj.size() * (beautify_ ? 2 : 1);
+        for (const auto& member : obj)
+            size += string(member.first.c_str(), member.first.length()) +
+                    value(member.second, depth + 1);
+
+        return size;
+    }
+    case array_type:
+        if (val.is_int64_array()) {
+            const auto span = val.get_int64_span();
+            size_t size = container(span.size(), depth);
+            for (const auto n : span)
+                size += detail::count_digits(n < 0 ? 0 - uint64_t(n) : uint64_t(n)) +
+                        (n < 0 ? 1 : 0);
+
+            return size;
+        }
+
+        if (val.is_real_array()) {
+            const auto span = val.get_real_span();
+            size_t size = container(span.size(), depth);
+            for (const auto d : span)
+                size += real(d);
+
+            return size;
+        }
+
+        {
+            const Array& arr = val.get_array();
+            size_t size = container(arr.size(), depth);
+            for (const auto& element : arr)
+                size += value(element, depth + 1);
+
+            return size;
+        }
+    case str_type: {
+        const std::string& str = val.get_str();
+        return string(str.data(), str.size());
+    }
+    case bool_type:
+        return val.get_bool() ? 4 : 5;
+    case int_type:
+        if (val.is_uint64())
+            return detail::count_digits(val.get_uint64());
+
+        return val.get_int64() < 0 ?
+                   detail::count_digits(0 - uint64_t(val.get_int64())) + 1 :
+                   detail::count_digits(uint64_t(val.get_int64()));
+    case real_type:
+        return real(val.get_real());
+    case null_type:
+        return 4;
+    }
+
+    return 0;
+}
+
+size_t Size_Counter::string(const char* s, size_t n)
+{
+    size_t size = n + 2;
+    for (;;) {
+        const size_t run = clean_run(s, n);
+        s += run;
+        n -= run;
+        if (!n)
+            return size;
+
+        size += escapes.table[static_cast<unsigned char>(*s++)] == 'u' ? 5 : 1;
+        --n;
+    }
+}
+
+size_t Size_Counter::real(double d)
+{
+    if (!std::isfinite(d))
+        return 4;
+
+    char buf[number_buffer_size];
+    return format_double(buf, d) - buf;
+}
+
+size_t Size_Counter::container(size_t n, unsigned depth)
+{
+    if (!beautify_)
+        return 2 + (n ? n - 1 : 0);
+
+    // Newlines after the opening and before the closing bracket, ",\n"
+    // between members and the indentation of each line.
+    return 4 + depth * 4 + (n ? (n - 1) * 2 : 0) + n * (depth + 1) * 4;
+}
+
+} // namespace
+
+void write_json(const Value& val, std::string& out, bool beautify)
+{
+    Text_Writer<std::string>(out, beautify, ACE_INVALID_HANDLE).write(val);
+}
+
+void write_json(const Value& val, std::vector<char>& out, bool beautify)
+{
+    Text_Writer<std::vector<char>>(out, beautify, ACE_INVALID_HANDLE).write(val);
+}
+
+bool write_json(const Value& val, ACE_HANDLE handle, bool beautify)
+{
+    std::string buf;
+    return Text_Writer<std::string>(buf, beautify, handle).write(val);
+}
+
+size_t serialized_size(const Value& val, bool beautify)
+{
+    return Size_Counter(beautify).size(val);
+}
+
+} // namespace bjson
@@ -0,0 +1,50 @@
+/// \file text_writer.h
+/// \brief JSON text of a Value written without yajl_gen.
+#ifndef BJSON_TEXT_WRITER_H
+#define BJSON_TEXT_WRITER_H
+
+#include "bjson_export.h"
+#include "bjson_value.h"
+
+#include <ace/os_include/sys/os_types.h>
+#include <string>
+#include <vector>
+
+namespace bjson {
+
+/// \brief Append the JSON text of \a val to \a out.
+///
+/// The text is byte for byte what JSON_Writer writes through yajl_gen, in
+/// compact form or, with \a beautify, indented by 4 spaces with a final
+/// newline. Strings are scanned 16 bytes at a time for the characters to
+/// escape. The exceptions are values yajl_gen cannot write at all: NaN and
+/// infinities are written null, and nesting is not limited to 128 levels.
+///
+/// Nothing is allocated while \a out has the capacity for the text, a
+/// buffer cleared and reused across calls soon stops allocating.
+BJSON_EXPORT void write_json(const Value& val,
+                             std::string& out,
+                             bool beautify = false);
+
+/// \copydoc write_json(const Value&, std::string&, bool)
+BJSON_EXPORT void write_json(const Value& val,
+                             std::vector<char>& out,
+                             bool beautify = false);
+
+/// \brief Write the JSON text of \a val to \a handle through a 64 KiB
+///        buffer.
+/// \return false if a write failed, errno tells why.
+BJSON_EXPORT bool write_json(const Value& val,
+                             ACE_HANDLE handle,
+                             bool beautify = false);
+
+/// \brief Exact size of the text write_json() writes for \a val, escapes
+///        included, e.g. for a Content-Length sent before the body.
+///
+/// It walks the tree like write_json() without writing: only reals are
+/// formatted, into a buffer on the stack.
+BJSON_EXPORT size_t serialized_size(const Value& val, bool beautify = false);
+
+} // namespace bjson
+
+#endif // BJSON_TEXT_WRITER_H
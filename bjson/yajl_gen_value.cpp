@@ -1,7 +1,8 @@
 #include "yajl_gen_value.h"
 
-#include <ace/Basic_Types.h>
-#include <ace/OS_NS_stdio.h>
+#include "number_format.h"
+
+#include <cmath>
 
 using namespace bjson;
 
@@ -13,15 +14,55 @@ void gen_map(yajl_gen g, const Value& val)
 
     const Object& obj = val.get_obj();
     for (const auto& i : obj) {
-        yajl_gen_string(g, (const unsigned char*)i->first.c_str(), i->first.length());
-        yajl_gen_value(g, i->second);
+        yajl_gen_string(g, (const unsigned char*)i.first.c_str(), i.first.length());
+        yajl_gen_value(g, i.second);
     }
 
     yajl_gen_map_close(g);
 }
 
+void gen_int64(yajl_gen g, int64_t val)
+{
+    char buf[number_buffer_size];
+    yajl_gen_number(g, buf, format_int64(buf, val) - buf);
+}
+
+void gen_double(yajl_gen g, double val)
+{
+    // yajl_gen_double() reports NaN and infinities as invalid.
+    if (!std::isfinite(val)) {
+        yajl_gen_double(g, val);
+        return;
+    }
+
+    char buf[number_buffer_size];
+    yajl_gen_number(g, buf, format_double(buf, val) - buf);
+}
+
+// Packed arrays are written straight from their buffer, without the boxed
+// copy get_array() const would make.
+void gen_packed_array(yajl_gen g, const Value& val)
+{
+    yajl_gen_array_open(g);
+
+    if (val.is_int64_array()) {
+        for (const auto i : val.get_int64_span())
+            gen_int64(g, i);
+    } else {
+        for (const auto i : val.get_real_span())
+            gen_double(g, i);
+    }
+
+    yajl_gen_array_close(g);
+}
+
 void gen_array(yajl_gen g, const Value& val)
 {
+    if (val.is_int64_array() || val.is_real_array()) {
+        gen_packed_array(g, val);
+        return;
+    }
+
     yajl_gen_array_open(g);
 
     const Array& arr = val.get_array();
@@ -42,11 +83,12 @@ void gen_string(yajl_gen g, const Value& val)
 
 void gen_int(yajl_gen g, const Value& val)
 {
-    char buf[32];
-    int len = val.is_uint64() ? ACE_OS::snprintf(buf, sizeof(buf), "%lu", val.get_uint64())
-                              : ACE_OS::snprintf(buf, sizeof(buf), "%ld", val.get_int64());
-
-    yajl_gen_number(g, buf, len);
+    if (val.is_uint64()) {
+        char buf[number_buffer_size];
+        yajl_gen_number(g, buf, format_uint64(buf, val.get_uint64()) - buf);
+    } else {
+        gen_int64(g, val.get_int64());
+    }
 }
 
 yajl_gen_status yajl_gen_value(yajl_gen g, const Value& val)
@@ -68,7 +110,7 @@ yajl_gen_status yajl_gen_value(yajl_gen g, const Value& val)
         gen_int(g, val);
         break;
     case real_type:
-        yajl_gen_double(g, val.get_real());
+        gen_double(g, val.get_real());
         break;
     case null_type:
         yajl_gen_null(g);